@@ -22,6 +22,7 @@
 #define ID_ANTIALIASING_FXAA            32778
 #define ID_ANTIALIASING_NONE            32779
 #define ID_DEBUG_LIGHTDIRECTION          32780
+#define ID_DEBUG_OCCLUSIONCULLING       32781
 #define IDC_STATIC                      -1
 
 // Next default values for new objects
@@ -30,7 +31,7 @@
 #ifndef APSTUDIO_READONLY_SYMBOLS
 #define _APS_NO_MFC                     1
 #define _APS_NEXT_RESOURCE_VALUE        129
-#define _APS_NEXT_COMMAND_VALUE         32781
+#define _APS_NEXT_COMMAND_VALUE         32782
 #define _APS_NEXT_CONTROL_VALUE         1000
 #define _APS_NEXT_SYMED_VALUE           110
 #endif
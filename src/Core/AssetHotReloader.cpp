@@ -0,0 +1,179 @@
+﻿#include "AssetHotReloader.h"
+#include "Graphics/Model.h"
+#include "Graphics/ModelLoader.h"
+#include "Graphics/ModelLoadHandle.h"
+#include "Graphics/Texture.h"
+#include "Platform/DirectoryWatcher.h"
+#include "Scene/GameObject.h"
+
+#include <algorithm>
+#include <array>
+#include <cwctype>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+
+namespace
+{
+    // 감시 이벤트와 로드 경로가 같은 파일을 같은 문자열로 가리키게 한다.
+    [[nodiscard]] std::filesystem::path normalize_asset_path(const std::filesystem::path& path)
+    {
+        std::error_code error;
+        auto canonical = std::filesystem::weakly_canonical(path, error);
+        return error ? path.lexically_normal() : canonical;
+    }
+
+    [[nodiscard]] std::wstring lowercase_extension(const std::filesystem::path& path)
+    {
+        std::wstring extension = path.extension().wstring();
+        std::ranges::transform(extension, extension.begin(), [](wchar_t c) { return static_cast<wchar_t>(std::towlower(c)); });
+        return extension;
+    }
+
+    // stb_image가 읽는 형식. .srmesh 캐시 쓰기 같은 다른 변경은 무시한다.
+    [[nodiscard]] bool is_image_extension(std::wstring_view extension) noexcept
+    {
+        constexpr std::array<std::wstring_view, 9> extensions{ L".png", L".jpg", L".jpeg", L".tga", L".bmp", L".psd", L".gif", L".hdr", L".pnm" };
+        return std::ranges::find(extensions, extension) != extensions.end();
+    }
+}
+
+AssetHotReloader::AssetHotReloader(const std::filesystem::path& assetDirectory)
+{
+    // 감시 실패는 자산 로드 실패가 아니다. 핫 리로드 없이 계속 실행한다.
+    if (auto watcher = sr::DirectoryWatcher::Open(assetDirectory))
+        m_watcher = std::move(*watcher);
+}
+
+AssetHotReloader::~AssetHotReloader() = default;
+
+void AssetHotReloader::Track(const std::shared_ptr<GameObject>& gameObject, const std::filesystem::path& modelPath,
+    const AccelerationSettings& acceleration)
+{
+    m_objects.push_back(TrackedObject{ gameObject, normalize_asset_path(modelPath), acceleration });
+}
+
+void AssetHotReloader::reloadModel(const std::filesystem::path& modelPath, const AccelerationSettings& acceleration)
+{
+    // 이미 다시 읽는 중이면 그 결과는 옛 내용일 수 있으므로 끝난 뒤 한 번 더 읽는다.
+    const auto inFlight = std::ranges::find_if(m_modelReloads, [&](const ModelReload& reload) {
+        return reload.modelPath == modelPath && reload.acceleration == acceleration;
+    });
+    if (inFlight != m_modelReloads.end())
+    {
+        inFlight->restart = true;
+        return;
+    }
+    // .srmesh 캐시는 원본/MTL의 크기와 시각으로 무효화되므로 바뀐 모델만 다시 파싱된다.
+    // 공유 핸들 캐시를 거치지 않아야 아직 살아 있는 옛 모델 대신 새로 읽는다.
+    m_modelReloads.push_back(ModelReload{ modelPath, acceleration, ModelLoader::LoadOBJAsync(modelPath, acceleration) });
+}
+
+void AssetHotReloader::reloadTexture(const std::filesystem::path& path)
+{
+    for (const auto& reload : m_textureReloads)
+    {
+        if (reload->path == path) reload->superseded = true;
+    }
+
+    auto reload = std::make_unique<TextureReload>();
+    reload->path = path;
+    TextureReload& target = *reload;
+    reload->worker = std::jthread([&target] {
+        target.result = TextureLoader::DecodeChangedImage(target.path);
+        target.done.store(true, std::memory_order_release);
+    });
+    m_textureReloads.push_back(std::move(reload));
+}
+
+std::vector<AssetLoadError> AssetHotReloader::ApplyChanges()
+{
+    std::vector<AssetLoadError> errors;
+    if (!m_watcher) return errors;
+
+    std::erase_if(m_objects, [](const TrackedObject& object) { return object.gameObject.expired(); });
+
+    // 1) 바뀐 파일을 그 파일에 걸린 자산의 재로드로 바꾼다.
+    for (const auto& changedPath : m_watcher->TakeChanges())
+    {
+        const auto path = normalize_asset_path(changedPath);
+        const std::wstring extension = lowercase_extension(path);
+        if (extension == L".obj" || extension == L".mtl")
+        {
+            // 인스턴스가 몇 개든 모델 파일마다 한 번만 다시 읽는다.
+            std::vector<const TrackedObject*> affectedModels;
+            for (const TrackedObject& object : m_objects)
+            {
+                const bool alreadyQueued = std::ranges::any_of(affectedModels, [&object](const TrackedObject* queued) {
+                    return queued->modelPath == object.modelPath && queued->acceleration == object.acceleration;
+                });
+                if (alreadyQueued) continue;
+                const auto gameObject = object.gameObject.lock();
+                if (!gameObject) continue;
+
+                bool affected = object.modelPath == path;
+                // 아직 첫 로드 중인 모델은 MTL을 읽기 전이므로 그 로드가 새 내용을 읽는다.
+                if (const Model* model = gameObject->GetModel(); !affected && model)
+                {
+                    affected = std::ranges::any_of(model->GetDependencies(), [&path](const std::filesystem::path& dependency) {
+                        return normalize_asset_path(dependency) == path;
+                    });
+                }
+                if (affected)
+                    affectedModels.push_back(&object);
+            }
+            for (const TrackedObject* object : affectedModels)
+                reloadModel(object->modelPath, object->acceleration);
+        }
+        else if (is_image_extension(extension))
+        {
+            reloadTexture(path);
+        }
+    }
+
+    // 2) 끝난 모델 재로드를 적용한다. 모델 전체가 준비된 뒤에만 바꿔 반쯤 로드된 모델이 보이지 않게 한다.
+    //    새 모델 하나를 그 파일을 쓰는 모든 인스턴스가 공유한다.
+    std::erase_if(m_modelReloads, [this, &errors](ModelReload& reload) {
+        const EModelLoadState state = reload.handle->GetState();
+        if (state == EModelLoadState::Loading) return false;
+
+        if (reload.restart)
+        {
+            reload.restart = false;
+            reload.handle = ModelLoader::LoadOBJAsync(reload.modelPath, reload.acceleration);
+            return false;
+        }
+
+        if (state != EModelLoadState::Ready)
+        {
+            errors.push_back(reload.handle->GetError());
+            return true;
+        }
+        const std::shared_ptr<const Model> model = reload.handle->GetModel();
+        for (const TrackedObject& object : m_objects)
+        {
+            if (object.modelPath != reload.modelPath || object.acceleration != reload.acceleration) continue;
+            if (const auto gameObject = object.gameObject.lock())
+                gameObject->SetModel(model);
+        }
+        return true;
+    });
+
+    // 3) 끝난 텍스처 디코드를 적용한다. 텍스처 객체를 제자리에서 바꾸므로 그 텍스처를
+    //    공유하는 모든 재질(캐시에서 복원한 모델 포함)이 다음 프레임부터 새 이미지를 쓴다.
+    std::erase_if(m_textureReloads, [&errors](const std::unique_ptr<TextureReload>& reload) {
+        if (!reload->done.load(std::memory_order_acquire)) return false;
+        if (reload->superseded) return true;
+        if (!reload->result)
+        {
+            errors.push_back(std::move(reload->result.error()));
+            return true;
+        }
+        for (TextureReplacement& replacement : *reload->result)
+            replacement.target->ReplaceContents(std::move(*replacement.replacement));
+        return true;
+    });
+
+    return errors;
+}
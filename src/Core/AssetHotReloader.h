@@ -0,0 +1,73 @@
+﻿#pragma once
+
+#include <atomic>
+#include <expected>
+#include <filesystem>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "Graphics/AccelerationSettings.h"
+#include "Graphics/TextureLoader.h"
+#include "Utils/AssetLoadError.h"
+
+class GameObject;
+class ModelLoadHandle;
+namespace sr { class DirectoryWatcher; }
+
+// 자산 폴더를 감시해 바뀐 OBJ/MTL/이미지를 렌더 스레드 밖에서 다시 읽고 프레임 사이에
+// 교체한다. 다시 읽는 동안에는 이전 자산을 계속 그리며, 실패하면 이전 자산을 유지한다.
+// 바뀐 파일에 걸린 모델이나 텍스처만 다시 읽고 나머지 씬은 건드리지 않는다.
+class AssetHotReloader
+{
+private:
+	struct TrackedObject
+	{
+		std::weak_ptr<GameObject> gameObject;
+		std::filesystem::path modelPath;	// 정규화된 OBJ 경로
+		AccelerationSettings acceleration;	// 다시 읽을 때도 같은 구조로 빌드한다
+	};
+
+	// 모델 파일 하나의 재로드. 그 모델을 공유하는 인스턴스 전부에 한 번에 적용한다.
+	struct ModelReload
+	{
+		std::filesystem::path modelPath;
+		AccelerationSettings acceleration;
+		std::shared_ptr<ModelLoadHandle> handle;
+		bool restart = false;	// 로드 중에 파일이 또 바뀌었다. 끝나면 결과를 버리고 다시 읽는다.
+	};
+
+	// 이미지 디코드 한 건. 작업 스레드는 마지막 멤버라 가장 먼저 join되므로
+	// 결과 멤버를 참조로 잡아도 수명이 안전하다.
+	struct TextureReload
+	{
+		std::filesystem::path path;
+		std::expected<std::vector<TextureReplacement>, AssetLoadError> result;
+		std::atomic<bool> done{ false };
+		bool superseded = false;	// 같은 파일의 더 새로운 재로드가 시작되었다
+		std::jthread worker;
+	};
+
+	std::unique_ptr<sr::DirectoryWatcher> m_watcher;
+	std::vector<TrackedObject> m_objects;
+	std::vector<ModelReload> m_modelReloads;
+	std::vector<std::unique_ptr<TextureReload>> m_textureReloads;
+
+	void reloadModel(const std::filesystem::path& modelPath, const AccelerationSettings& acceleration);
+	void reloadTexture(const std::filesystem::path& path);
+
+public:
+	// 디렉터리를 감시할 수 없으면(없는 폴더 등) 아무 일도 하지 않는 상태가 된다.
+	explicit AssetHotReloader(const std::filesystem::path& assetDirectory);
+	~AssetHotReloader();
+	AssetHotReloader(const AssetHotReloader&) = delete;
+	AssetHotReloader& operator=(const AssetHotReloader&) = delete;
+
+	[[nodiscard]] bool IsWatching() const noexcept { return m_watcher != nullptr; }
+
+	void Track(const std::shared_ptr<GameObject>& gameObject, const std::filesystem::path& modelPath,
+		const AccelerationSettings& acceleration = {});
+
+	// 렌더링이 없는 시점(프레임의 Update 시작)에 호출한다. 바뀐 파일의 재로드를 시작하고
+	// 끝난 재로드를 GameObject와 텍스처에 적용한 뒤, 실패한 재로드의 오류를 돌려준다.
+	[[nodiscard]] std::vector<AssetLoadError> ApplyChanges();
+};
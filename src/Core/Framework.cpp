@@ -1,12 +1,16 @@
 ﻿#include "Framework.h"
 #include "resource.h"
+#include "Core/AssetHotReloader.h"
 #include "Renderer/Renderer.h"
 #include "Math/Frustum.h"
 #include "Scene/GameObject.h"
 #include "Graphics/ModelLoader.h"
+#include "Graphics/ModelLoadHandle.h"
 #include "Graphics/Model.h"
+#include "Graphics/AccelerationStructure.h"
 #include "Utils/Utils.h"
 
+#include <algorithm>
 #include <array>
 #include <numbers>
 #include <utility>
@@ -16,6 +20,12 @@ namespace
 constexpr float kLightGizmoLength = 1.5f;
 constexpr float kArrowHeadLength = 0.3f;
 constexpr float kArrowHeadWidth = 0.18f;
+// Culling hierarchy for scene models. A BVH keeps triangles that straddle octant
+// borders out of the root, so long or irregular parts still cull.
+constexpr AccelerationSettings kSceneAcceleration{ .type = EAccelerationStructure::Bvh };
+// Triangles rasterized into the occlusion buffer per frame. Meshes are taken whole,
+// nearest object first, and a mesh that does not fit the remaining budget is skipped.
+constexpr std::size_t kOccluderTriangleBudget = 64 * 1024;
 
 // GetDC/ReleaseDC is a paired Win32 resource API. A scoped owner makes future
 // early returns safe and keeps raw HDC lifetime out of the frame loop.
@@ -48,6 +58,18 @@ private:
     return converted;
 }
 
+// 로더는 예외나 UI 호출 대신 구조화 오류를 반환한다. Framework만이
+// WinAPI 사용자 메시지로 변환하므로 로더 테스트와 재사용이 쉬워진다.
+void ShowAssetLoadError(HWND window, const AssetLoadError& error)
+{
+    std::wstring message = Utf8ToWide(error.message);
+    if (!error.path.empty())
+        message += L"\nPath: " + error.path.wstring();
+    if (error.line != 0)
+        message += L"\nLine: " + std::to_wstring(error.line);
+    MessageBoxW(window, message.c_str(), L"GameObject Creation Error", MB_OK | MB_ICONERROR);
+}
+
 void AddDebugLine(DebugPrimitiveCommand& command, const SRMath::vec3& from,
     const SRMath::vec3& to, const SRMath::vec4& color)
 {
@@ -130,14 +152,19 @@ Framework::Framework(HINSTANCE hInstance, int nCmdShow)
 
     m_pRenderer = std::make_unique<Renderer>(m_hWnd);
     m_perfAnalyzer = PerformanceAnalyzer();
+    m_hotReloader = std::make_unique<AssetHotReloader>(GetAssetDirectory());
+
+    // 모델은 백그라운드에서 로드되고 첫 프레임은 자산 크기와 무관하게 그려진다.
+    // 로드 실패는 Update에서 보고된다.
+    initializeGameobject(SRMath::vec3(0.f, 0.f, 0.f), SRMath::vec3(0.f, 0.f, 0.0f),
+        SRMath::vec3(0.04f, 0.04f, 0.04f), "IronMan");
 
-    if (!initializeGameobject(SRMath::vec3(0.f, 0.f, 0.f), SRMath::vec3(0.f, 0.f, 0.0f),
-        SRMath::vec3(0.04f, 0.04f, 0.04f), "IronMan"))
-        throw std::runtime_error("Failed to initialize IronMan GameObject");
+    initializeGameobject(SRMath::vec3(-10.f, 0.f, 0.f), SRMath::vec3(0.f, 0.f, 0.0f),
+        SRMath::vec3(0.04f, 0.04f, 0.04f), "teapot");
 
-    if (!initializeGameobject(SRMath::vec3(-10.f, 0.f, 0.f), SRMath::vec3(0.f, 0.f, 0.0f),
-        SRMath::vec3(0.04f, 0.04f, 0.04f), "teapot"))
-        throw std::runtime_error("Failed to initialize teapot GameObject");
+    // 주전자 인스턴스들은 위의 주전자와 같은 로드를 공유하고 변환만 다르다.
+    initializeInstanceGrid(SRMath::vec3(-20.f, -6.f, 10.f), 8, 4, 6.f,
+        SRMath::vec3(0.04f, 0.04f, 0.04f), "teapot");
 
     m_camera = Camera(SRMath::vec3(0.f, 0.f, -5.f));
 
@@ -149,27 +176,72 @@ Framework::Framework(HINSTANCE hInstance, int nCmdShow)
 
 Framework::~Framework() = default;
 
-bool Framework::initializeGameobject(const SRMath::vec3& pos, const SRMath::vec3& rotation,
+void Framework::initializeGameobject(const SRMath::vec3& pos, const SRMath::vec3& rotation,
     const SRMath::vec3& scale, std::string_view modelName)
 {
-    const auto modelPath = MakeAssetPath(modelName);
-    auto model = ModelLoader::LoadOBJ(modelPath);
-    if (!model)
+    // 같은 모델을 이미 읽고 있거나 읽었으면 그 로드를 공유한다.
+    auto loadHandle = ModelLoader::AcquireOBJAsync(MakeAssetPath(modelName), kSceneAcceleration);
+    auto gameObject = std::make_shared<GameObject>(pos, rotation, scale, loadHandle);
+    m_hotReloader->Track(gameObject, loadHandle->GetPath(), loadHandle->GetAccelerationSettings());
+
+    const auto pending = std::ranges::find(m_pendingLoads, loadHandle, &PendingLoad::handle);
+    if (pending != m_pendingLoads.end())
+        pending->gameObjects.push_back(gameObject);
+    else if (loadHandle->GetState() != EModelLoadState::Ready)
+        m_pendingLoads.push_back(PendingLoad{ std::move(loadHandle), { gameObject } });
+    m_gameobjects.push_back(std::move(gameObject));
+    m_rebuildSceneBvh = true;
+}
+
+void Framework::initializeInstanceGrid(const SRMath::vec3& origin, int countX, int countZ, float spacing,
+    const SRMath::vec3& scale, std::string_view modelName)
+{
+    m_gameobjects.reserve(m_gameobjects.size() + static_cast<std::size_t>(countX) * static_cast<std::size_t>(countZ));
+    for (int z = 0; z < countZ; ++z)
     {
-        // 로더는 예외나 UI 호출 대신 구조화 오류를 반환한다. Framework만이
-        // WinAPI 사용자 메시지로 변환하므로 로더 테스트와 재사용이 쉬워진다.
-        std::wstring message = Utf8ToWide(model.error().message);
-        if (!model.error().path.empty())
-            message += L"\nPath: " + model.error().path.wstring();
-        if (model.error().line != 0)
-            message += L"\nLine: " + std::to_wstring(model.error().line);
-        MessageBoxW(m_hWnd, message.c_str(), L"GameObject Creation Error", MB_OK | MB_ICONERROR);
-        return false;
+        for (int x = 0; x < countX; ++x)
+        {
+            const SRMath::vec3 position = origin + SRMath::vec3(static_cast<float>(x) * spacing, 0.f, static_cast<float>(z) * spacing);
+            // 회전 위상을 인스턴스마다 달리해 같은 모델임을 알아보기 쉽게 한다.
+            const SRMath::vec3 rotation(0.f, 0.7f * static_cast<float>(x + z * countX), 0.f);
+            initializeGameobject(position, rotation, scale, modelName);
+        }
     }
+}
 
-    auto gameObject = std::make_shared<GameObject>(pos, rotation, scale, std::move(*model));
-    m_gameobjects.push_back(std::move(gameObject));
-    return true;
+void Framework::pollPendingLoads()
+{
+    std::erase_if(m_pendingLoads, [this](const PendingLoad& load) {
+        switch (load.handle->GetState())
+        {
+        case EModelLoadState::Loading:
+            return false;
+        case EModelLoadState::Failed:
+            // 실패한 오브젝트는 씬에서 빼고 나머지 자산으로 계속 실행한다.
+            ShowAssetLoadError(m_hWnd, load.handle->GetError());
+            std::erase_if(m_gameobjects, [&load](const std::shared_ptr<GameObject>& gameObject) {
+                return std::ranges::find(load.gameObjects, gameObject) != load.gameObjects.end();
+            });
+            m_rebuildSceneBvh = true;
+            return true;
+        default:
+            return true;
+        }
+    });
+}
+
+void Framework::applyAssetReloads()
+{
+    // 편집 중 저장한 파일은 잠깐 깨져 있을 수 있다. 대화 상자로 렌더 루프를 멈추지 않고
+    // 디버그 출력으로만 알리며, 해당 자산은 이전 버전을 계속 그린다.
+    for (const AssetLoadError& error : m_hotReloader->ApplyChanges())
+    {
+        std::wstring message = L"Asset reload failed: " + Utf8ToWide(error.message);
+        if (error.line != 0)
+            message += L" (line " + std::to_wstring(error.line) + L")";
+        message += L"\n";
+        OutputDebugStringW(message.c_str());
+    }
 }
 
 void Framework::Run()
@@ -223,24 +295,106 @@ void Framework::Update(const float deltaTime)
     const float aspectRatio = static_cast<float>(width) / static_cast<float>(height);
     m_camera.Update(deltaTime, m_keys, aspectRatio);
 
+    pollPendingLoads();
+    // 렌더 큐를 다시 채우기 전이므로 지난 프레임의 명령이 교체될 모델을 가리키지 않는다.
+    applyAssetReloads();
+
 	m_renderQueue.Clear();
 
-    const Frustum& frustum = m_camera.GetFrustum();
     for (const auto& gameObject : m_gameobjects)
     {
-        if (gameObject)
+        if (gameObject) gameObject->Update(deltaTime, m_isRotateMode);
+    }
+
+    // 빈 상자(nullptr 오브젝트나 아직 메시가 없는 오브젝트)는 어떤 질의에도 나오지 않는다.
+    const auto worldBounds = [this](std::size_t index) {
+        return m_gameobjects[index] ? m_gameobjects[index]->GetWorldAABB() : AABB{};
+    };
+    if (m_rebuildSceneBvh)
+    {
+        m_sceneBounds.clear();
+        for (std::size_t i = 0; i < m_gameobjects.size(); ++i) m_sceneBounds.push_back(worldBounds(i));
+        m_sceneBvh.Build(m_sceneBounds);
+        m_rebuildSceneBvh = false;
+    }
+    else
+    {
+        for (std::size_t i = 0; i < m_gameobjects.size(); ++i) m_sceneBvh.SetBounds(i, worldBounds(i));
+        m_sceneBvh.Refit();
+    }
+
+    const Frustum& frustum = m_camera.GetFrustum();
+    m_visibleObjects.clear();
+    m_sceneBvh.QueryFrustum(frustum, m_visibleObjects);
+
+    // 오클루더를 먼저 그린 뒤 가려진 오브젝트와 노드는 명령을 만들지 않는다.
+    const OcclusionBuffer* occlusion = nullptr;
+    if (m_debugFlags.bOcclusionCulling)
+    {
+        rasterizeOccluders();
+        occlusion = &m_occlusionBuffer;
+    }
+
+    for (const std::size_t index : m_visibleObjects)
+    {
+        m_gameobjects[index]->SubmitToRenderQueue(m_renderQueue, frustum, occlusion, m_debugFlags);
+    }
+
+    if (m_debugFlags.bShowLightDirection)
+        SubmitDirectionalLightGizmos(m_renderQueue, m_lights);
+}
+
+// 절두체를 통과한 최상위 오브젝트를 카메라에서 가까운 순서로 정렬해 오클루전 버퍼에 그린다.
+// 가까운 물체가 가장 많이 가리므로 삼각형 예산을 먼저 쓴다. 지난 프레임에 그린 기록이 있는
+// 메시는 실제로 픽셀을 남긴 노드만 그리고(1단계), 나머지 노드는 순회에서 이 버퍼로 검사한다(2단계).
+// 기록이 없는 메시는 통째로 그린다. 뒤가 비치는 재질은 아무것도 가리지 않는다.
+void Framework::rasterizeOccluders()
+{
+    m_occlusionBuffer.Clear(m_camera.GetProjectionMatrix() * m_camera.GetViewMatrix());
+
+    m_occluderOrder.clear();
+    for (const std::size_t index : m_visibleObjects)
+    {
+        if (m_gameobjects[index]->GetModel())
+            m_occluderOrder.push_back(index);
+    }
+
+    const SRMath::vec3 eye = m_camera.GetCameraPos();
+    const auto distanceSquared = [&](std::size_t index) {
+        const AABB& bounds = m_gameobjects[index]->GetWorldAABB();
+        const SRMath::vec3 closest{
+            std::clamp(eye.x, bounds.min.x, bounds.max.x),
+            std::clamp(eye.y, bounds.min.y, bounds.max.y),
+            std::clamp(eye.z, bounds.min.z, bounds.max.z) };
+        return SRMath::lengthSq(closest - eye);
+    };
+    std::ranges::sort(m_occluderOrder, {}, distanceSquared);
+
+    std::size_t budget = kOccluderTriangleBudget;
+    for (const std::size_t index : m_occluderOrder)
+    {
+        const GameObject& gameObject = *m_gameobjects[index];
+        const Model& model = *gameObject.GetModel();
+        const std::span<const Mesh> meshes = model.GetMeshes();
+        for (std::size_t i = 0; i < meshes.size(); ++i)
         {
-            gameObject->Update(deltaTime, m_isRotateMode);
+            const Mesh& mesh = meshes[i];
+            if (!model.IsMeshReady(i) || mesh.material.alphaMode != EAlphaMode::Opaque) continue;
 
-            if (frustum.IsAABBInFrustum(gameObject->GetWorldAABB()))
+            const AccelerationStructure::VisibilityHistory* history = gameObject.GetVisibilityHistory(i);
+            if (mesh.acceleration && history && !history->IsEmpty())
             {
-                gameObject->SubmitToRenderQueue(m_renderQueue, frustum, m_debugFlags);
+                budget -= mesh.acceleration->RasterizeVisibleNodes(m_occlusionBuffer, *history, gameObject.GetWorldMatrix(), budget);
+                continue;
             }
+
+            const std::size_t triangles = mesh.GetIndices().size() / 3;
+            if (triangles > budget) continue;
+
+            m_occlusionBuffer.RasterizeMesh(mesh, gameObject.GetWorldMatrix());
+            budget -= triangles;
         }
     }
-
-    if (m_debugFlags.bShowLightDirection)
-        SubmitDirectionalLightGizmos(m_renderQueue, m_lights);
 }
 
 void Framework::Render()
@@ -295,6 +449,11 @@ LRESULT Framework::HandleMessage(HWND hWnd, UINT message, WPARAM wParam, LPARAM
             CheckMenuBox(m_debugFlags.bShowLightDirection, ID_DEBUG_LIGHTDIRECTION);
             break;
 
+        case ID_DEBUG_OCCLUSIONCULLING:
+            m_debugFlags.bOcclusionCulling = !m_debugFlags.bOcclusionCulling;
+            CheckMenuBox(m_debugFlags.bOcclusionCulling, ID_DEBUG_OCCLUSIONCULLING);
+            break;
+
         case ID_ANTIALIASING_NONE:
             m_pRenderer->SetAAAlgorithm(EAAAlgorithm::None);
             CheckMenuBox(m_debugFlags.bShowWireframe, ID_DEBUG_WIREFRAME);
@@ -12,11 +12,15 @@
 #include "Math/SRMath.h"
 #include "Scene/Camera.h"
 #include "Renderer/RenderQueue.h"
+#include "Renderer/OcclusionBuffer.h"
+#include "Scene/SceneBvh.h"
 #include "Graphics/Light.h"
 #include "Utils/DebugUtils.h"
 
 class Renderer;
 class GameObject;
+class ModelLoadHandle;
+class AssetHotReloader;
 
 class Framework
 {
@@ -48,13 +52,40 @@ private:
 
 	// Model Variables
 	std::vector<std::shared_ptr<GameObject>> m_gameobjects; // 게임오브젝트 리스트
+	// 최상위 오브젝트의 월드 AABB 계층. m_gameobjects의 위치가 오브젝트 번호이므로 목록이
+	// 바뀌면 m_rebuildSceneBvh를 켜서 다시 만들고, 그 밖에는 움직인 오브젝트만 refit한다.
+	SceneBvh m_sceneBvh;
+	bool m_rebuildSceneBvh = true;
+	std::vector<AABB> m_sceneBounds;	// 재구축 때 모으는 작업 버퍼
+	std::vector<std::size_t> m_visibleObjects;	// 이번 프레임에 절두체를 통과한 오브젝트 번호
+	// 절두체를 통과한 가까운 오브젝트의 메시를 먼저 그려 두는 저해상도 깊이 버퍼와 그 순서 작업 버퍼
+	OcclusionBuffer m_occlusionBuffer;
+	std::vector<std::size_t> m_occluderOrder;
+
+	// 백그라운드 로드가 끝나지 않은 모델과 그 모델을 공유하는 인스턴스들.
+	// 실패하면 오류를 한 번 보고하고 인스턴스를 모두 씬에서 뺀다.
+	struct PendingLoad
+	{
+		std::shared_ptr<ModelLoadHandle> handle;
+		std::vector<std::shared_ptr<GameObject>> gameObjects;
+	};
+	std::vector<PendingLoad> m_pendingLoads;
+
+	// 자산 폴더의 변경을 감시해 바뀐 모델/텍스처만 실행 중에 다시 읽는다.
+	std::unique_ptr<AssetHotReloader> m_hotReloader;
 
 	// Camera Variables
 	Camera m_camera;
 
 	// Load Gameobject
-	[[nodiscard]] bool initializeGameobject(const SRMath::vec3& pos, const SRMath::vec3& rotation,
+	void initializeGameobject(const SRMath::vec3& pos, const SRMath::vec3& rotation,
 		const SRMath::vec3& scale, std::string_view modelName);
+	// 모델 하나를 공유하는 인스턴스를 XZ 평면 격자로 배치한다.
+	void initializeInstanceGrid(const SRMath::vec3& origin, int countX, int countZ, float spacing,
+		const SRMath::vec3& scale, std::string_view modelName);
+	void pollPendingLoads();
+	void applyAssetReloads();
+	void rasterizeOccluders();
 
 public:
 	explicit Framework(HINSTANCE hInstance, int nCmdShow);
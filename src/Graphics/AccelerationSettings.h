@@ -0,0 +1,23 @@
+﻿#pragma once
+#include <cstdint>
+
+// 메시 컬링용 계층 구조의 종류. 두 빌더 모두 같은 평탄한 노드 배열을 만들기 때문에
+// 순회, 캐시 레코드, 렌더 경로는 종류와 무관하다.
+enum class EAccelerationStructure : std::uint8_t
+{
+	Octree,	// 중점 8분할 (느슨한 자식 경계 지원). 빌드가 가장 빠르다
+	Bvh		// 구간 SAH 2분할. 자식 경계가 삼각형에 딱 맞고 모든 삼각형이 리프에 있다
+};
+
+struct AccelerationSettings
+{
+	EAccelerationStructure type = EAccelerationStructure::Octree;
+	// 리프가 가질 수 있는 최대 삼각형 수. 이보다 많이 받은 노드는 분할한다.
+	// 리프 하나가 렌더 명령 하나가 되므로 너무 작으면 명령 처리 비용이 커진다.
+	std::uint32_t maxLeafTriangles = 16;
+	// 옥트리 자식 경계를 셀의 몇 배로 키울지 (1 이상, BVH는 무시). 1이면 셀 경계에 걸친
+	// 삼각형이 부모에 쌓이는 고전 옥트리이고, 2면 자식 셀 절반 크기까지의 삼각형이 모두 내려간다.
+	float octreeLooseness = 2.f;
+
+	[[nodiscard]] bool operator==(const AccelerationSettings&) const = default;
+};
@@ -0,0 +1,265 @@
+﻿#include "AccelerationStructure.h"
+#include <utility>
+#include "Graphics/Bvh.h"
+#include "Graphics/Mesh.h"
+#include "Graphics/Octree.h"
+#include "Math/Frustum.h"
+#include "Renderer/OcclusionBuffer.h"
+#include "Utils/DebugUtils.h"
+
+namespace
+{
+	// VisibilityHistory의 노드별 비트. history_drawn은 렌더러가 켠다.
+	constexpr std::uint8_t history_drawn = MeshRenderCommand::feedback_drawn;
+	constexpr std::uint8_t history_subtree_command = 2;	// 명령이 하위 트리 전체를 그렸다
+}
+
+AccelerationStructure::AccelerationStructure() = default;
+AccelerationStructure::~AccelerationStructure() = default;
+
+AABB AccelerationStructure::NodeBounds(const Node& node) noexcept
+{
+	AABB bounds;
+	bounds.min = { node.boundsMin[0], node.boundsMin[1], node.boundsMin[2] };
+	bounds.max = { node.boundsMax[0], node.boundsMax[1], node.boundsMax[2] };
+	return bounds;
+}
+
+void AccelerationStructure::Build(const Mesh& mesh, const AccelerationSettings& settings)
+{
+	sourceMesh = &mesh;                 // 삼각형 정점 참조용 원본 메시 포인터 보관
+	m_settings = settings;
+
+	BuildResult result = settings.type == EAccelerationStructure::Bvh
+		? Bvh(mesh, settings.maxLeafTriangles).Build()
+		: Octree(mesh, settings.maxLeafTriangles, settings.octreeLooseness).Build();
+
+	m_nodeStorage = std::move(result.nodes);
+	m_nodeIndices = std::move(result.nodeIndices);
+	m_nodes = m_nodeStorage;
+	m_indices = m_nodeIndices;
+}
+
+bool AccelerationStructure::Restore(const Mesh& mesh, const AccelerationSettings& settings,
+	std::span<const Node> nodes, std::span<const unsigned int> indices)
+{
+	sourceMesh = &mesh;
+	m_settings = settings;
+	m_nodeStorage.clear();
+	m_nodeIndices.clear();
+	m_nodes = {};
+	m_indices = {};
+	if (nodes.empty()) return false;
+
+	// 손상된 입력이 순회 중 배열 밖을 읽거나 순환하지 않도록 구간과 자식 위치를 확인한다.
+	// 너비 우선 배치에서 자식은 항상 부모보다 뒤에 있다.
+	for (std::size_t i = 0; i < nodes.size(); ++i)
+	{
+		const Node& node = nodes[i];
+		if (static_cast<std::size_t>(node.indexBegin) + node.subtreeIndexCount > indices.size()) return false;
+		if (node.indexCount > node.subtreeIndexCount) return false;
+		if (node.childCount > 8) return false;
+		if (node.childCount != 0
+			&& (node.firstChild <= i || static_cast<std::size_t>(node.firstChild) + node.childCount > nodes.size()))
+			return false;
+	}
+
+	m_nodes = nodes;
+	m_indices = indices;
+	return true;
+}
+
+// 보이는 노드 하나를 명령으로 만든다(디버그 AABB 포함). indexCount는 노드 자신의 삼각형만
+// 그릴 때 node.indexCount, 하위 트리 전체를 그릴 때 node.subtreeIndexCount다.
+void AccelerationStructure::submitNode(std::uint32_t instanceIndex,
+	std::vector<MeshRenderCommand>& threadLocalCmd, std::vector<DebugPrimitiveCommand>& threadlocalDebugCmd,
+	const DebugFlags& debugFlags, const Node& node, std::uint32_t indexCount, const SRMath::mat4& worldTransform,
+	std::uint8_t* feedback) const
+{
+	// 이 노드에 삼각형이 있으면 렌더 큐에 메시 렌더 명령 제출
+	if (indexCount != 0)
+	{
+		MeshRenderCommand cmd;
+		cmd.sourceMesh = this->sourceMesh;                 // 원본 메시
+		cmd.indicesToDraw = m_indices.subspan(node.indexBegin, indexCount); // 이 노드(또는 하위 트리)에 속한 삼각형 인덱스 서브셋
+		cmd.instanceIndex = instanceIndex;                 // 인스턴스 버퍼의 월드 변환
+		cmd.material = &this->sourceMesh->material;        // 메시의 재질을 사용
+		cmd.visibilityFeedback = feedback;                 // 렌더러가 픽셀을 남겼는지 기록할 위치
+
+		// 와이어/필 모드 전환 (디버그 플래그에 따름)
+		if (debugFlags.bShowWireframe)
+		{
+			cmd.rasterizeMode = ERasterizeMode::Wireframe;
+		}
+		else
+		{
+			cmd.rasterizeMode = ERasterizeMode::Fill;
+		}
+
+		threadLocalCmd.push_back(cmd); // 멀티스레드 로컬 렌더 명령 큐에 추가
+	}
+
+	// 디버그: 노드 AABB를 선분으로 렌더 큐에 제출
+	if (debugFlags.bShowAABB)
+	{
+		// AABB 8개 꼭짓점 계산(로컬 공간. 인스턴스 변환과 함께 그리므로 회전된 상자로 보인다)
+		const auto vertices = NodeBounds(node).Corners();
+		SRMath::vec4 color = SRMath::vec4(1.0f, 0.0f, 0.0f, 1.0f); // 빨간색
+		std::vector<DebugVertex> debugVertices;
+
+		// 12개의 엣지를 선분으로 추가 (Bottom/Top/Sides)
+		debugVertices.insert(debugVertices.end(), {
+			{vertices[0], color}, {vertices[1], color}, {vertices[1], color}, {vertices[3], color}, {vertices[3], color}, {vertices[2], color}, {vertices[2], color}, {vertices[0], color}, // Bottom
+			{vertices[4], color}, {vertices[5], color}, {vertices[5], color}, {vertices[7], color}, {vertices[7], color}, {vertices[6], color}, {vertices[6], color}, {vertices[4], color}, // Top
+			{vertices[0], color}, {vertices[4], color}, {vertices[1], color}, {vertices[5], color}, {vertices[2], color}, {vertices[6], color}, {vertices[3], color}, {vertices[7], color}  // Sides
+			});
+
+		// 디버그 프리미티브(선분) 제출
+		DebugPrimitiveCommand cmd;
+		cmd.vertices = debugVertices;
+		cmd.worldTransform = worldTransform;
+		cmd.type = DebugPrimitiveType::Line;
+		threadlocalDebugCmd.push_back(cmd);
+	}
+}
+
+// 렌더러가 채운 기록을 이번 순회가 읽을 '그 전 프레임' 기록으로 넘기고, 새 기록을 받을 배열을
+// 비운다. 두 프레임 전 기록에서 켜져 있던 노드만 되돌리므로 비용은 명령 수에 비례한다.
+void AccelerationStructure::beginHistoryFrame(VisibilityHistory& history) const
+{
+	// 처음 그리는 인스턴스는 기록이 없다.
+	if (history.m_feedback.size() != m_nodes.size() || history.m_previous.size() != m_nodes.size())
+	{
+		history.m_feedback.assign(m_nodes.size(), 0);
+		history.m_previous.assign(m_nodes.size(), 0);
+		history.m_submitted.clear();
+		history.m_previousSubmitted.clear();
+	}
+
+	for (const std::uint32_t index : history.m_previousSubmitted)
+		history.m_previous[index] = 0;
+	std::swap(history.m_feedback, history.m_previous);
+	std::swap(history.m_submitted, history.m_previousSubmitted);
+	history.m_submitted.clear();
+}
+
+std::size_t AccelerationStructure::RasterizeVisibleNodes(OcclusionBuffer& occlusion, const VisibilityHistory& history,
+	const SRMath::mat4& worldTransform, std::size_t triangleBudget) const
+{
+	if (history.m_feedback.size() != m_nodes.size()) return 0;
+
+	std::size_t rasterized = 0;
+	for (const std::uint32_t index : history.m_submitted)
+	{
+		const std::uint8_t record = history.m_feedback[index];
+		if ((record & history_drawn) == 0) continue;
+
+		// 명령이 그린 구간을 그대로 다시 그린다. 예산을 넘는 노드는 건너뛰고 더 작은 노드를 찾는다.
+		const Node& node = m_nodes[index];
+		const std::uint32_t indexCount = (record & history_subtree_command) != 0 ? node.subtreeIndexCount : node.indexCount;
+		const std::size_t triangles = indexCount / 3;
+		if (triangles > triangleBudget - rasterized) continue;
+
+		occlusion.RasterizeTriangles(*sourceMesh, m_indices.subspan(node.indexBegin, indexCount), worldTransform);
+		rasterized += triangles;
+	}
+	return rasterized;
+}
+
+// 루트부터 보이는 노드들을 렌더 큐에 제출한다. 재귀 대신 명시적 스택으로 노드 배열을 순회하며,
+// 보이는 노드의 자식들은 AABB를 SoA로 모아 SIMD 한 번으로 함께 검사한다. 절두체를 메시의
+// 로컬 공간으로 한 번 옮겨 두므로 노드 경계는 저장된 값을 그대로 쓴다.
+void AccelerationStructure::SubmitNodesToRenderQueue(const Frustum& frustum, const OcclusionBuffer* occlusion,
+	VisibilityHistory* history, const SRMath::mat4& worldTransform, std::uint32_t instanceIndex,
+	std::vector<MeshRenderCommand>& threadLocalCmd, std::vector<DebugPrimitiveCommand>& threadlocalDebugCmd, const DebugFlags& debugFlags) const
+{
+	if (m_nodes.empty()) return; // 빌드되지 않은 경우 무시
+
+	// 루트가 절두체 밖이어도 기록은 넘겨 둔다. 이번 프레임에 그린 노드가 없다는 것도 기록이다.
+	if (history) beginHistoryFrame(*history);
+
+	// 스택에는 검사를 이미 통과한 노드와, 그 노드가 아직 걸쳐 있는 평면 집합을 쌓는다.
+	// 부모가 완전히 안쪽인 평면은 자식에게도 성립하므로 자식 검사에서 뺀다.
+	struct VisibleNode
+	{
+		std::uint32_t index;
+		std::uint32_t crossedPlanes;
+	};
+
+	// 각 노드의 로컬 AABB를 배치의 lane칸에 넣는다.
+	const auto setBounds = [](SRMath::SIMD::AABBx8& batch, std::size_t lane, const Node& node) {
+		batch.Set(lane, { node.boundsMin[0], node.boundsMin[1], node.boundsMin[2] },
+			{ node.boundsMax[0], node.boundsMax[1], node.boundsMax[2] });
+	};
+
+	const Frustum localFrustum = frustum.ToObjectSpace(worldTransform);
+	SRMath::SIMD::AABBx8 rootBatch;
+	setBounds(rootBatch, 0, m_nodes[0]);
+	const SRMath::SIMD::PlaneTestMask rootMask = localFrustum.TestAABBs(rootBatch);
+	if ((rootMask.visible & 1u) == 0) return;
+
+	// 메시마다 병렬로 불리므로 스레드별 스택을 재사용해 순회마다 할당하지 않는다.
+	thread_local std::vector<VisibleNode> stack;
+	stack.clear();
+	stack.push_back({ 0, rootMask.CrossedPlanes(0) & Frustum::all_planes });
+	while (!stack.empty())
+	{
+		const VisibleNode visible = stack.back();
+		stack.pop_back();
+		const Node& node = m_nodes[visible.index];
+
+		// 지난 프레임에 픽셀을 남긴 노드는 그 삼각형이 1단계에서 오클루더로 그려졌으므로(예산 안이라면)
+		// 가려졌다고 나올 수 없다. 하위 트리째 그릴지 정해야 할 때만 검사한다.
+		const bool wasVisible = history && (history->m_previous[visible.index] & history_drawn) != 0;
+		EOcclusionTest occlusionTest = EOcclusionTest::Unoccluded;
+		if (occlusion)
+		{
+			occlusionTest = wasVisible && visible.crossedPlanes != 0
+				? EOcclusionTest::Visible
+				: occlusion->TestAABB(NodeBounds(node), worldTransform);
+		}
+
+		// 가려진 노드는 하위 트리 전체가 그 상자 안에 있으므로 함께 버린다.
+		if (occlusionTest == EOcclusionTest::Occluded) continue;
+
+		// 명령을 만드는 노드는 렌더러가 결과를 적을 자리를 받는다.
+		std::uint8_t* nodeFeedback = nullptr;
+		const bool batchSubtree = visible.crossedPlanes == 0 && occlusionTest == EOcclusionTest::Unoccluded;
+		if (history && (batchSubtree ? node.subtreeIndexCount : node.indexCount) != 0)
+		{
+			nodeFeedback = &history->m_feedback[visible.index];
+			if (batchSubtree) *nodeFeedback = history_subtree_command;
+			history->m_submitted.push_back(visible.index);
+		}
+
+		// 모든 평면 안쪽이고 어느 부분도 가려지지 않았으면 하위 트리의 삼각형이 인덱스 버퍼에서
+		// 이어져 있으므로 더 내려가지 않고 명령 하나로 그린다. 일부만 가려졌으면 계속 내려가
+		// 가려진 자식을 골라낸다.
+		if (batchSubtree)
+		{
+			submitNode(instanceIndex, threadLocalCmd, threadlocalDebugCmd, debugFlags, node, node.subtreeIndexCount, worldTransform, nodeFeedback);
+			continue;
+		}
+
+		submitNode(instanceIndex, threadLocalCmd, threadlocalDebugCmd, debugFlags, node, node.indexCount, worldTransform, nodeFeedback);
+		if (node.childCount == 0) continue;
+
+		// 자식은 최대 8개(Restore가 확인한다)라서 한 배치에 모두 들어간다. 부모가 이미 모든
+		// 평면 안쪽이면 절두체 검사 없이 모두 보인다.
+		SRMath::SIMD::PlaneTestMask childMask{ ~0u, ~0u, 0 };
+		if (visible.crossedPlanes != 0)
+		{
+			SRMath::SIMD::AABBx8 children;
+			for (std::uint32_t child = 0; child < node.childCount; ++child)
+				setBounds(children, child, m_nodes[node.firstChild + child]);
+			childMask = localFrustum.TestAABBs(children, visible.crossedPlanes);
+		}
+
+		// 첫 자식이 먼저 나오도록 역순으로 쌓는다.
+		for (std::uint32_t child = node.childCount; child-- > 0;)
+		{
+			if (((childMask.visible >> child) & 1u) == 0) continue;
+			stack.push_back({ node.firstChild + child, childMask.CrossedPlanes(child) & visible.crossedPlanes });
+		}
+	}
+}
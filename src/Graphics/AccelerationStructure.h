@@ -0,0 +1,105 @@
+﻿#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+#include "Math/SRMath.h"
+#include "Math/AABB.h"
+#include "Graphics/AccelerationSettings.h"
+#include "Renderer/RenderCommand.h"
+
+struct Mesh;
+class Frustum;
+class OcclusionBuffer;
+struct DebugFlags;
+
+// 메시 하나의 컬링용 계층 구조. 빌더(Octree, Bvh)가 만든 평탄한 노드 배열과
+// 노드 순서로 재배열한 인덱스 버퍼를 가지며, 순회는 빌더 종류와 무관하다.
+class AccelerationStructure
+{
+public:
+	// 너비 우선 순서로 한 배열에 놓인 노드. 캐시 파일에도 이 레코드가 그대로 기록되어
+	// 복원할 때 매핑된 파일을 복사 없이 가리킨다. 삼각형이 없는 하위 트리는 만들지 않으므로
+	// 자식은 0~8개이며 firstChild부터 연속으로 놓인다. 루트(0)는 누구의 자식도 아니다.
+	// 인덱스 버퍼는 깊이 우선 순서라서 노드 자신의 삼각형 뒤에 하위 트리 전체의 삼각형이
+	// 이어진다. 절두체 안에 완전히 들어간 노드는 그 구간을 명령 하나로 그린다.
+	struct Node
+	{
+		float boundsMin[3];
+		float boundsMax[3];
+		std::uint32_t indexBegin;	// GetNodeIndices() 안의 시작 위치
+		std::uint32_t indexCount;	// 노드 자신의 삼각형
+		std::uint32_t subtreeIndexCount;	// 노드와 모든 자손의 삼각형
+		std::uint32_t firstChild;
+		std::uint32_t childCount;
+	};
+
+	// 인스턴스 하나가 이 구조를 지난 프레임에 어떻게 그렸는지에 대한 노드별 기록. 모델은 여러
+	// GameObject가 공유하므로 인스턴스마다 메시별로 하나씩 둔다. 순회가 명령에 기록 위치를 달면
+	// 렌더러가 실제로 픽셀을 남긴 명령을 표시하고, 다음 프레임이 그 노드를 오클루더로 먼저 그린 뒤
+	// 나머지만 오클루전 검사한다(2단계 시간적 오클루전 컬링).
+	class VisibilityHistory
+	{
+		friend class AccelerationStructure;
+		// 두 배열은 노드 수만큼이고 명령을 만든 노드만 0이 아니다. 프레임마다 전체를 지우지 않도록
+		// 그 노드 번호를 따로 모아 두고 그것만 되돌린다.
+		std::vector<std::uint8_t> m_feedback;	// 마지막으로 제출한 명령들이 가리키는 기록
+		std::vector<std::uint8_t> m_previous;	// 순회 중에 읽는 그 전 프레임의 기록
+		std::vector<std::uint32_t> m_submitted;
+		std::vector<std::uint32_t> m_previousSubmitted;
+
+	public:
+		[[nodiscard]] bool IsEmpty() const noexcept { return m_feedback.empty(); }
+	};
+
+	// 빌더가 채우는 결과
+	struct BuildResult
+	{
+		std::vector<Node> nodes;
+		std::vector<unsigned int> nodeIndices;
+	};
+
+private:
+	const Mesh* sourceMesh = nullptr;
+	AccelerationSettings m_settings;
+
+	// 노드와 노드별 삼각형 목록을 각각 한 버퍼에 둔다. 캐시에서 복원한 구조는
+	// 두 vector 대신 매핑된 파일을 가리킨다.
+	std::vector<Node> m_nodeStorage;
+	std::span<const Node> m_nodes;
+	std::vector<unsigned int> m_nodeIndices;
+	std::span<const unsigned int> m_indices;
+
+	void submitNode(std::uint32_t instanceIndex,
+		std::vector<MeshRenderCommand>& threadLocalCmd, std::vector<DebugPrimitiveCommand>& localDebugCmd,
+		const DebugFlags& debugFlags, const Node& node, std::uint32_t indexCount, const SRMath::mat4& worldTransform,
+		std::uint8_t* feedback) const;
+	void beginHistoryFrame(VisibilityHistory& history) const;
+
+public:
+	AccelerationStructure();
+	~AccelerationStructure();
+
+	void Build(const Mesh& mesh, const AccelerationSettings& settings);
+	// GetNodes()와 GetNodeIndices()를 그대로 받아 구조를 복원한다. 두 span은
+	// mesh가 살아 있는 동안 유효해야 하며 복사하지 않는다.
+	[[nodiscard]] bool Restore(const Mesh& mesh, const AccelerationSettings& settings,
+		std::span<const Node> nodes, std::span<const unsigned int> indices);
+
+	[[nodiscard]] const AccelerationSettings& GetSettings() const noexcept { return m_settings; }
+	[[nodiscard]] std::span<const Node> GetNodes() const noexcept { return m_nodes; }
+	[[nodiscard]] std::span<const unsigned int> GetNodeIndices() const noexcept { return m_indices; }
+	[[nodiscard]] static AABB NodeBounds(const Node& node) noexcept;
+
+	// worldTransform은 절두체를 로컬 공간으로 옮기는 데 쓰고, 명령에는 RenderQueue 인스턴스 버퍼의 instanceIndex만 기록한다.
+	// occlusion이 있으면 절두체를 통과한 노드도 오클루더에 완전히 가려졌으면 하위 트리째 건너뛴다.
+	// history가 있으면 지난 프레임에 픽셀을 남긴 노드는 오클루전 검사를 생략하고, 이번 명령의 결과를 기록하게 한다.
+	void SubmitNodesToRenderQueue(const Frustum& frustum, const OcclusionBuffer* occlusion,
+		VisibilityHistory* history, const SRMath::mat4& worldTransform, std::uint32_t instanceIndex,
+		std::vector<MeshRenderCommand>& threadLocalCmd, std::vector<DebugPrimitiveCommand>& localDebugCmd, const DebugFlags& debugFlags) const;
+
+	// 마지막 순회에서 픽셀을 남긴 노드의 삼각형을 오클루더로 그린다. triangleBudget을 넘지 않게
+	// 노드 단위로 고르며 그린 삼각형 수를 돌려준다.
+	std::size_t RasterizeVisibleNodes(OcclusionBuffer& occlusion, const VisibilityHistory& history,
+		const SRMath::mat4& worldTransform, std::size_t triangleBudget) const;
+};
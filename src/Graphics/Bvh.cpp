@@ -0,0 +1,283 @@
+﻿#include "Bvh.h"
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <memory>
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_invoke.h>
+#include <tbb/parallel_reduce.h>
+#include "Graphics/Mesh.h"
+
+// 빌드 중에만 존재하는 노드. 양쪽 자식을 병렬로 빌드하기 쉽도록 포인터 트리로 만들고
+// Build 끝에서 AccelerationStructure::Node 배열로 평탄화한 뒤 통째로 해제한다.
+class Bvh::BuildNode {
+public:
+	AABB bounds;
+	std::size_t begin = 0;	// m_triangles 안의 구간
+	std::size_t end = 0;
+	std::array<std::unique_ptr<BuildNode>, 2> children{};
+};
+
+namespace
+{
+	// 노드 구간 삼각형들의 경계와 삼각형 중심들의 경계
+	struct RangeBounds
+	{
+		AABB bounds;
+		AABB centroidBounds;
+
+		void Encapsulate(const RangeBounds& other) noexcept
+		{
+			bounds.Encapsulate(other.bounds);
+			centroidBounds.Encapsulate(other.centroidBounds);
+		}
+	};
+
+	[[nodiscard]] float surface_area(const AABB& box) noexcept
+	{
+		if (!box.IsValid()) return 0.f;
+		const SRMath::vec3 size = box.max - box.min;
+		return 2.f * (size.x * size.y + size.y * size.z + size.z * size.x);
+	}
+}
+
+Bvh::Bvh(const Mesh& mesh, std::size_t maxLeafTriangles)
+	: m_mesh(mesh),
+	  m_maxLeafTriangles(std::max<std::size_t>(maxLeafTriangles, 1))
+{
+}
+
+Bvh::~Bvh() = default;
+
+AccelerationStructure::BuildResult Bvh::Build()
+{
+	const auto vertices = m_mesh.GetVertices();
+	const auto indices = m_mesh.GetIndices();
+	const std::size_t triangleCount = indices.size() / 3;
+
+	// 삼각형별 경계와 중심은 분할 단계마다 다시 읽으므로 한 번만 구해 둔다.
+	m_triangleBounds.resize(triangleCount);
+	m_centroids.resize(triangleCount);
+	m_triangles.resize(triangleCount);
+	tbb::parallel_for(tbb::blocked_range<std::size_t>(0, triangleCount, 1024),
+		[&](const tbb::blocked_range<std::size_t>& range) {
+			for (std::size_t t = range.begin(); t != range.end(); ++t)
+			{
+				AABB box;
+				box.Encapsulate(vertices[indices[t * 3]].position);
+				box.Encapsulate(vertices[indices[t * 3 + 1]].position);
+				box.Encapsulate(vertices[indices[t * 3 + 2]].position);
+				m_triangleBounds[t] = box;
+				m_centroids[t] = (box.min + box.max) * 0.5f;
+				m_triangles[t] = static_cast<std::uint32_t>(t);
+			}
+		});
+
+	BuildNode root;
+	root.end = triangleCount;
+	if (triangleCount == 0)
+		root.bounds = AABB::CreateFromMesh(m_mesh);
+	else
+		buildNode(&root);
+
+	auto result = flatten(root);
+	m_triangleBounds = {};
+	m_centroids = {};
+	m_triangles = {};
+	return result;
+}
+
+void Bvh::buildNode(BuildNode* node)
+{
+	const std::size_t triangleCount = node->end - node->begin;
+	const bool parallel = triangleCount >= parallel_build_triangles;
+
+	const auto accumulate = [this](std::size_t begin, std::size_t end, RangeBounds bounds) {
+		for (std::size_t i = begin; i != end; ++i)
+		{
+			const std::uint32_t t = m_triangles[i];
+			bounds.bounds.Encapsulate(m_triangleBounds[t]);
+			bounds.centroidBounds.Encapsulate(m_centroids[t]);
+		}
+		return bounds;
+	};
+	const RangeBounds range = parallel
+		? tbb::parallel_reduce(tbb::blocked_range<std::size_t>(node->begin, node->end, parallel_build_triangles / 4), RangeBounds{},
+			[&accumulate](const tbb::blocked_range<std::size_t>& r, RangeBounds bounds) { return accumulate(r.begin(), r.end(), bounds); },
+			[](RangeBounds lhs, const RangeBounds& rhs) { lhs.Encapsulate(rhs); return lhs; })
+		: accumulate(node->begin, node->end, RangeBounds{});
+
+	// 자식 경계는 부모의 옥탄트가 아니라 실제 삼각형에 맞춘다.
+	node->bounds = range.bounds;
+	if (triangleCount <= m_maxLeafTriangles) return;
+
+	const std::size_t mid = split(node->begin, node->end, range.centroidBounds);
+	for (std::size_t i = 0; i < node->children.size(); ++i)
+	{
+		node->children[i] = std::make_unique<BuildNode>();
+		node->children[i]->begin = i == 0 ? node->begin : mid;
+		node->children[i]->end = i == 0 ? mid : node->end;
+	}
+
+	BuildNode* left = node->children[0].get();
+	BuildNode* right = node->children[1].get();
+	if (parallel)
+	{
+		tbb::parallel_invoke([this, left] { buildNode(left); }, [this, right] { buildNode(right); });
+	}
+	else
+	{
+		buildNode(left);
+		buildNode(right);
+	}
+}
+
+// [begin, end)를 SAH 비용이 가장 낮은 구간 경계에서 둘로 나누고 경계 위치를 돌려준다.
+// 비용은 자식 경계의 표면적 × 삼각형 수의 합이며, 광선 대신 프러스텀에 걸릴
+// 확률도 표면적에 비례한다는 근사를 그대로 쓴다.
+std::size_t Bvh::split(std::size_t begin, std::size_t end, const AABB& centroidBounds)
+{
+	struct Bin
+	{
+		AABB bounds;
+		std::size_t count = 0;
+	};
+	using Bins = std::array<std::array<Bin, bin_count>, 3>;
+
+	std::array<float, 3> scale{};
+	for (std::size_t axis = 0; axis < 3; ++axis)
+	{
+		const float extent = centroidBounds.max[axis] - centroidBounds.min[axis];
+		scale[axis] = extent > 0.f ? static_cast<float>(bin_count) / extent : 0.f;
+	}
+	const auto binOf = [&](std::uint32_t t, std::size_t axis) {
+		const float offset = (m_centroids[t][axis] - centroidBounds.min[axis]) * scale[axis];
+		return std::min(bin_count - 1, static_cast<std::size_t>(offset));
+	};
+
+	const auto fill = [&](std::size_t rangeBegin, std::size_t rangeEnd, Bins bins) {
+		for (std::size_t i = rangeBegin; i != rangeEnd; ++i)
+		{
+			const std::uint32_t t = m_triangles[i];
+			for (std::size_t axis = 0; axis < 3; ++axis)
+			{
+				if (scale[axis] == 0.f) continue;
+				Bin& bin = bins[axis][binOf(t, axis)];
+				bin.bounds.Encapsulate(m_triangleBounds[t]);
+				++bin.count;
+			}
+		}
+		return bins;
+	};
+	const Bins bins = end - begin >= parallel_build_triangles
+		? tbb::parallel_reduce(tbb::blocked_range<std::size_t>(begin, end, parallel_build_triangles / 4), Bins{},
+			[&fill](const tbb::blocked_range<std::size_t>& r, Bins partial) { return fill(r.begin(), r.end(), partial); },
+			[](Bins lhs, const Bins& rhs) {
+				for (std::size_t axis = 0; axis < 3; ++axis)
+				{
+					for (std::size_t b = 0; b < bin_count; ++b)
+					{
+						lhs[axis][b].bounds.Encapsulate(rhs[axis][b].bounds);
+						lhs[axis][b].count += rhs[axis][b].count;
+					}
+				}
+				return lhs;
+			})
+		: fill(begin, end, Bins{});
+
+	// 축마다 오른쪽 누적 비용을 먼저 구하고, 왼쪽을 쓸어 가며 경계 b(구간 b부터 오른쪽)를 평가한다.
+	float bestCost = std::numeric_limits<float>::max();
+	std::size_t bestAxis = 3;
+	std::size_t bestBin = 0;
+	for (std::size_t axis = 0; axis < 3; ++axis)
+	{
+		if (scale[axis] == 0.f) continue;
+
+		std::array<float, bin_count> rightCost{};
+		AABB rightBounds;
+		std::size_t rightCount = 0;
+		for (std::size_t b = bin_count - 1; b > 0; --b)
+		{
+			rightBounds.Encapsulate(bins[axis][b].bounds);
+			rightCount += bins[axis][b].count;
+			rightCost[b] = surface_area(rightBounds) * static_cast<float>(rightCount);
+		}
+
+		AABB leftBounds;
+		std::size_t leftCount = 0;
+		for (std::size_t b = 1; b < bin_count; ++b)
+		{
+			leftBounds.Encapsulate(bins[axis][b - 1].bounds);
+			leftCount += bins[axis][b - 1].count;
+			if (leftCount == 0 || leftCount == end - begin) continue;
+
+			const float cost = surface_area(leftBounds) * static_cast<float>(leftCount) + rightCost[b];
+			if (cost < bestCost)
+			{
+				bestCost = cost;
+				bestAxis = axis;
+				bestBin = b;
+			}
+		}
+	}
+
+	// 중심이 모두 한 점에 모이면(같은 위치에 겹친 삼각형 무리) 어느 분할도 경계를 줄이지
+	// 못하므로 구간을 그대로 반으로 나눈다.
+	if (bestAxis == 3) return begin + (end - begin) / 2;
+
+	const auto mid = std::partition(m_triangles.begin() + static_cast<std::ptrdiff_t>(begin), m_triangles.begin() + static_cast<std::ptrdiff_t>(end),
+		[&](std::uint32_t t) { return binOf(t, bestAxis) < bestBin; });
+	return static_cast<std::size_t>(mid - m_triangles.begin());
+}
+
+// 빌드 트리를 너비 우선으로 펼친다. 인덱스 버퍼는 m_triangles 순서 그대로라서
+// 노드의 [begin, end)가 곧 하위 트리의 삼각형 구간이고, 리프만 자기 삼각형을 가진다.
+AccelerationStructure::BuildResult Bvh::flatten(const BuildNode& root) const
+{
+	using Node = AccelerationStructure::Node;
+	const auto indices = m_mesh.GetIndices();
+
+	AccelerationStructure::BuildResult result;
+	result.nodeIndices.resize(m_triangles.size() * 3);
+	tbb::parallel_for(tbb::blocked_range<std::size_t>(0, m_triangles.size(), 1024),
+		[&](const tbb::blocked_range<std::size_t>& range) {
+			for (std::size_t k = range.begin(); k != range.end(); ++k)
+			{
+				const std::size_t t = m_triangles[k];
+				std::copy_n(indices.begin() + static_cast<std::ptrdiff_t>(t * 3), 3,
+					result.nodeIndices.begin() + static_cast<std::ptrdiff_t>(k * 3));
+			}
+		});
+
+	const auto makeNode = [](const BuildNode& node) {
+		const auto subtreeIndexCount = static_cast<std::uint32_t>((node.end - node.begin) * 3);
+		return Node{
+			{ node.bounds.min.x, node.bounds.min.y, node.bounds.min.z },
+			{ node.bounds.max.x, node.bounds.max.y, node.bounds.max.z },
+			static_cast<std::uint32_t>(node.begin * 3),
+			node.children[0] ? 0u : subtreeIndexCount,
+			subtreeIndexCount,
+			0u, 0u };
+	};
+
+	std::vector<const BuildNode*> order{ &root };
+	result.nodes.push_back(makeNode(root));
+	for (std::size_t i = 0; i < order.size(); ++i)
+	{
+		const BuildNode& node = *order[i];
+		if (!node.children[0]) continue;
+
+		// push_back이 재할당할 수 있으므로 참조 대신 인덱스로 기록한다.
+		result.nodes[i].firstChild = static_cast<std::uint32_t>(order.size());
+		result.nodes[i].childCount = static_cast<std::uint32_t>(node.children.size());
+		for (const auto& child : node.children)
+		{
+			order.push_back(child.get());
+			result.nodes.push_back(makeNode(*child));
+		}
+	}
+
+	result.nodes.shrink_to_fit();
+	return result;
+}
@@ -0,0 +1,42 @@
+﻿#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Math/SRMath.h"
+#include "Math/AABB.h"
+#include "Graphics/AccelerationStructure.h"
+
+struct Mesh;
+
+// 구간(binned) SAH로 삼각형 집합을 둘로 나누는 AccelerationStructure 빌더.
+// 노드 경계는 담긴 삼각형에 딱 맞고 모든 삼각형이 리프에 있으므로, 가늘고 긴 메시나
+// 고르지 않은 메시에서도 걸친 삼각형이 루트에 쌓여 컬링되지 않는 일이 없다.
+class Bvh
+{
+private:
+	class BuildNode; // 빌드 중에만 쓰는 포인터 트리. 평탄화한 뒤 버린다.
+
+	const Mesh& m_mesh;
+	std::size_t m_maxLeafTriangles;
+
+	// 삼각형별 경계와 중심. m_triangles는 삼각형 번호이며 노드 구간별로 제자리 분할된다.
+	std::vector<AABB> m_triangleBounds;
+	std::vector<SRMath::vec3> m_centroids;
+	std::vector<std::uint32_t> m_triangles;
+
+	void buildNode(BuildNode* node);
+	[[nodiscard]] std::size_t split(std::size_t begin, std::size_t end, const AABB& centroidBounds);
+	[[nodiscard]] AccelerationStructure::BuildResult flatten(const BuildNode& root) const;
+
+	// 축마다 중심 범위를 이만큼의 구간으로 나눠 분할 후보를 평가한다.
+	static constexpr std::size_t bin_count = 16;
+	// 이보다 많은 삼각형이 도달한 노드는 경계 계산, 구간 분류, 자식 빌드를 병렬로 실행한다.
+	static constexpr std::size_t parallel_build_triangles = 4096;
+public:
+	Bvh(const Mesh& mesh, std::size_t maxLeafTriangles);
+	~Bvh();
+	Bvh(const Bvh&) = delete;
+	Bvh& operator=(const Bvh&) = delete;
+
+	[[nodiscard]] AccelerationStructure::BuildResult Build();
+};
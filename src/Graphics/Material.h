@@ -1,10 +1,20 @@
 ﻿#pragma once
+#include <cstdint>
 #include <memory>
 #include <string>
 #include "Math/SRMath.h"
+#include "Graphics/TextureTypes.h"
 
 class Texture;
 
+// 불투명도 처리 방식. 로더가 d/map_d에서 정하며, 호출자가 재질마다 덮어쓸 수 있다.
+enum class EAlphaMode : std::uint8_t
+{
+	Opaque,	// opacity를 무시하고 깊이를 쓴다
+	Mask,	// alphaCutoff 미만 픽셀을 셰이딩 전에 버린다 (잎사귀, 철망)
+	Blend	// 불투명 패스 뒤 타일 단위 OIT로 합성하고 깊이는 쓰지 않는다 (유리)
+};
+
 struct Material
 {
 	std::string name;						// 머티리얼 이름
@@ -16,6 +26,16 @@ struct Material
 
 	// 여러 mesh material이 같은 이미지 수명을 공유하므로 shared_ptr가 맞다.
 	// 빈 상태는 nullptr 리터럴보다 값 초기화로 표현한다.
-	std::shared_ptr<Texture> diffuseTexture{};
+	std::shared_ptr<Texture> diffuseTexture{};	// map_Kd: diffuse에 곱한다
+	std::shared_ptr<Texture> specularTexture{};	// map_Ks: specular에 곱한다
+	std::shared_ptr<Texture> shininessTexture{};	// map_Ns: 스칼라(R 채널), shininess에 곱한다
+	std::shared_ptr<Texture> normalTexture{};		// map_Bump/bump/norm: 접선 공간 법선 맵
+	std::shared_ptr<Texture> opacityTexture{};	// map_d: 스칼라(alpha 또는 R 채널), opacity에 곱한다
+	float bumpMultiplier = 1.0f;				// map_Bump -bm: 법선의 접선 성분 배율
+	EAlphaMode alphaMode = EAlphaMode::Opaque;
+	float alphaCutoff = 0.5f;					// Mask 모드의 버림 기준
+	// 이 재질의 텍스처를 로드할 때 사용할 내부 포맷 (MTL "sr_texture_format"). 자주
+	// 표본되는 텍스처는 RGBA32F/RGBA16F로 메모리를 더 쓰고 표본당 변환 비용을 없앨 수 있다.
+	ETextureFormat textureFormat = ETextureFormat::RGBA8;
 	int illuminationModel = 2; // MTL illum 2: Phong 반사 모델
 };
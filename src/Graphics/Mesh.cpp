@@ -1,5 +1,5 @@
 ﻿#include "Mesh.h"
-#include "Octree.h"
+#include "AccelerationStructure.h"
 
 Mesh::Mesh() = default;
 Mesh::~Mesh() = default;
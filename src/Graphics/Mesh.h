@@ -2,11 +2,12 @@
 #include <vector>
 #include <string>
 #include <memory>
+#include <span>
 #include "Math/SRMath.h"
 #include "Graphics/Material.h"
 #include "Math/AABB.h"
 
-class Octree;
+class AccelerationStructure;
 
 struct Vertex {
 	SRMath::vec3 position;	// v
@@ -19,7 +20,13 @@ struct Mesh {
 	std::vector<unsigned int> indices;      // 정점을 연결해 삼각형을 만드는 방법 (IBO용)
 	Material				  material;		// 이 메시에 적용할 재질
 	AABB					  localAABB;	// 이 메시에 적용할 로컬 AABB
-	std::unique_ptr<Octree>	  octree;
+	std::unique_ptr<AccelerationStructure> acceleration; // 컬링용 계층 구조 (옥트리 또는 BVH)
+
+	// 바이너리 캐시(.srmesh)에서 읽은 메시는 매핑된 파일을 복사 없이 가리킨다.
+	// 이때 위의 소유 벡터는 비어 있고, externalStorage가 매핑 수명을 유지한다.
+	std::shared_ptr<const void>	  externalStorage;
+	std::span<const Vertex>		  externalVertices;
+	std::span<const unsigned int> externalIndices;
 
 	Mesh();
 	~Mesh();
@@ -27,4 +34,13 @@ struct Mesh {
 	Mesh& operator=(Mesh&&) noexcept;
 
 	[[nodiscard]] const AABB& GetLocalAABB() const noexcept { return localAABB; }
+	// 읽기 경로는 저장소 종류와 무관하게 이 두 뷰만 사용한다.
+	[[nodiscard]] std::span<const Vertex> GetVertices() const noexcept
+	{
+		return externalStorage ? externalVertices : std::span<const Vertex>{ vertices };
+	}
+	[[nodiscard]] std::span<const unsigned int> GetIndices() const noexcept
+	{
+		return externalStorage ? externalIndices : std::span<const unsigned int>{ indices };
+	}
 };
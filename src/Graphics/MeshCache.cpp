@@ -0,0 +1,556 @@
+﻿#include "Graphics/MeshCache.h"
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <expected>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+#include <tbb/parallel_for.h>
+#include "Graphics/Model.h"
+#include "Graphics/Mesh.h"
+#include "Graphics/AccelerationStructure.h"
+#include "Graphics/Material.h"
+#include "Graphics/Texture.h"
+#include "Graphics/TextureLoader.h"
+#include "Math/AABB.h"
+#include "Platform/MappedFile.h"
+
+namespace
+{
+	// 레이아웃이나 기록하는 열거형 값이 바뀌면 올린다. 다른 버전의 파일은 캐시 미스가 되어 다시 쓰인다.
+	constexpr std::uint32_t cache_version = 6;
+	constexpr std::array<char, 8> cache_magic{ 'S', 'R', 'M', 'E', 'S', 'H', '\0', '\0' };
+	// 배열은 파일 시작 기준 16바이트 경계에 둔다. 매핑 주소는 페이지 정렬이므로
+	// SSE 유니온인 Vertex를 매핑된 메모리에서 바로 읽을 수 있다.
+	constexpr std::uint64_t array_alignment = 16;
+	constexpr std::size_t hash_block_bytes = std::size_t{ 1 } << 20;
+	constexpr std::uint64_t missing_file = ~std::uint64_t{ 0 };
+
+	// SRMath 벡터는 w 성분을 0으로 맞추는 복사 생성자가 있어 trivially copyable은
+	// 아니지만, 멤버가 모두 float/__m128 유니온이라 바이트 그대로 읽어도 같은 값이다.
+	static_assert(std::is_standard_layout_v<Vertex> && std::is_trivially_destructible_v<Vertex>,
+		"Vertex는 파일 바이트로 그대로 읽힌다");
+	static_assert(alignof(Vertex) <= array_alignment);
+	static_assert(std::is_trivially_copyable_v<AccelerationStructure::Node>);
+
+	struct FileHeader
+	{
+		std::array<char, 8> magic;
+		std::uint32_t version;
+		std::uint32_t vertexStride;	// sizeof(Vertex): 정점 배치가 다른 빌드가 쓴 파일을 거른다
+		std::uint32_t dependencyCount;
+		std::uint32_t meshCount;
+		std::uint32_t accelerationType;		// EAccelerationStructure
+		std::uint32_t maxLeafTriangles;
+		float octreeLooseness;
+	};
+
+	struct DependencyRecord
+	{
+		std::uint64_t size;		// missing_file: 기록 당시 없던 파일 (생기면 무효)
+		std::int64_t writeTime;
+		std::uint64_t hash;
+	};
+
+	struct MeshRecord
+	{
+		std::uint64_t vertexCount;
+		std::uint64_t indexCount;
+		std::uint64_t nodeCount;
+		std::uint64_t nodeIndexCount;
+		float boundsMin[3];
+		float boundsMax[3];
+	};
+
+	struct MaterialRecord
+	{
+		float ambient[3];
+		float diffuse[3];
+		float specular[3];
+		float shininess;
+		float opacity;
+		float bumpMultiplier;
+		float alphaCutoff;
+		std::int32_t illuminationModel;
+		std::uint8_t alphaMode;
+		std::uint8_t textureFormat;
+		std::uint8_t textureMask;	// 비트 i: texture_slots[i]의 TextureRecord가 뒤따른다
+		std::uint8_t reserved;
+	};
+
+	struct TextureRecord
+	{
+		std::uint8_t format;
+		std::uint8_t wrap;
+	};
+
+	// 이미지 texel은 캐시에 넣지 않는다. 경로와 포맷만 기록하고 로드 시 텍스처
+	// 캐시를 거쳐 다시 얻으므로 이미지 파일 교체는 캐시를 무효화하지 않는다.
+	constexpr std::array texture_slots{
+		&Material::diffuseTexture, &Material::specularTexture, &Material::shininessTexture,
+		&Material::normalTexture, &Material::opacityTexture };
+
+	void store_vec3(const SRMath::vec3& value, float (&out)[3]) noexcept
+	{
+		out[0] = value.x;
+		out[1] = value.y;
+		out[2] = value.z;
+	}
+
+	SRMath::vec3 load_vec3(const float (&in)[3]) noexcept
+	{
+		return SRMath::vec3{ in[0], in[1], in[2] };
+	}
+
+	// 경로는 캐시 파일 디렉터리 기준 상대 경로(UTF-8)로 기록해 자산 폴더를
+	// 통째로 옮겨도 캐시가 유효하다.
+	std::string encode_path(const std::filesystem::path& path, const std::filesystem::path& baseDirectory)
+	{
+		std::error_code error;
+		const auto absolute = std::filesystem::absolute(path, error);
+		const auto relative = (error ? path : absolute).lexically_proximate(baseDirectory).generic_u8string();
+		return std::string(reinterpret_cast<const char*>(relative.data()), relative.size());
+	}
+
+	std::filesystem::path decode_path(std::string_view encoded, const std::filesystem::path& baseDirectory)
+	{
+		const std::u8string utf8(reinterpret_cast<const char8_t*>(encoded.data()), encoded.size());
+		return (baseDirectory / std::filesystem::path(utf8)).lexically_normal();
+	}
+
+	std::uint64_t fnv1a(std::string_view bytes, std::uint64_t hash = 14695981039346656037ull) noexcept
+	{
+		for (const char byte : bytes)
+		{
+			hash ^= static_cast<unsigned char>(byte);
+			hash *= 1099511628211ull;
+		}
+		return hash;
+	}
+
+	// 1 MiB 블록별 해시를 병렬로 구한 뒤 순서대로 접는다. 결과는 스레드 수와 무관하다.
+	std::optional<std::uint64_t> hash_file(const std::filesystem::path& path)
+	{
+		auto mapped = sr::MappedFile::Open(path);
+		if (!mapped) return std::nullopt;
+
+		const std::string_view bytes = mapped->View();
+		const std::size_t blockCount = (bytes.size() + hash_block_bytes - 1) / hash_block_bytes;
+		std::vector<std::uint64_t> blockHashes(blockCount);
+		tbb::parallel_for(std::size_t{ 0 }, blockCount, [&](std::size_t i) {
+			blockHashes[i] = fnv1a(bytes.substr(i * hash_block_bytes, hash_block_bytes));
+		});
+		return fnv1a(std::string_view(reinterpret_cast<const char*>(blockHashes.data()), blockHashes.size() * sizeof(std::uint64_t)));
+	}
+
+	DependencyRecord stat_file(const std::filesystem::path& path)
+	{
+		std::error_code error;
+		const auto size = std::filesystem::file_size(path, error);
+		if (error) return { missing_file, 0, 0 };
+		const auto writeTime = std::filesystem::last_write_time(path, error);
+		if (error) return { missing_file, 0, 0 };
+		return { size, static_cast<std::int64_t>(writeTime.time_since_epoch().count()), 0 };
+	}
+
+	// 파일 전체를 메모리에 모으지 않고 스트림에 바로 쓴다. 정렬 패딩을 넣기 위해
+	// 현재 오프셋만 추적한다.
+	class CacheWriter
+	{
+	private:
+		std::ofstream m_stream;
+		std::uint64_t m_offset = 0;
+
+		void bytes(const void* data, std::size_t size)
+		{
+			m_stream.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+			m_offset += size;
+		}
+
+	public:
+		explicit CacheWriter(const std::filesystem::path& path) : m_stream(path, std::ios::binary | std::ios::trunc) {}
+
+		[[nodiscard]] bool Good() const { return m_stream.good(); }
+		bool Close()
+		{
+			m_stream.close();
+			return !m_stream.fail();
+		}
+
+		template<typename T>
+		void Pod(const T& value) { bytes(&value, sizeof(T)); }
+
+		void String(std::string_view text)
+		{
+			Pod(static_cast<std::uint32_t>(text.size()));
+			bytes(text.data(), text.size());
+		}
+
+		template<typename T>
+		void Array(std::span<const T> values)
+		{
+			static constexpr char padding[array_alignment]{};
+			bytes(padding, static_cast<std::size_t>((array_alignment - m_offset % array_alignment) % array_alignment));
+			bytes(values.data(), values.size_bytes());
+		}
+	};
+
+	// 모든 읽기는 남은 바이트 수를 먼저 확인한다. 잘리거나 손상된 파일은
+	// 실패로 끝날 뿐 매핑 범위 밖을 읽지 않는다.
+	class CacheReader
+	{
+	private:
+		std::string_view m_data;
+		std::size_t m_cursor = 0;
+
+	public:
+		explicit CacheReader(std::string_view data) : m_data(data) {}
+
+		[[nodiscard]] std::size_t Offset() const noexcept { return m_cursor; }
+
+		template<typename T>
+		[[nodiscard]] bool Pod(T& value) noexcept
+		{
+			if (m_data.size() - m_cursor < sizeof(T)) return false;
+			std::memcpy(&value, m_data.data() + m_cursor, sizeof(T));
+			m_cursor += sizeof(T);
+			return true;
+		}
+
+		[[nodiscard]] bool String(std::string& out)
+		{
+			std::uint32_t length = 0;
+			if (!Pod(length) || m_data.size() - m_cursor < length) return false;
+			out.assign(m_data.data() + m_cursor, length);
+			m_cursor += length;
+			return true;
+		}
+
+		template<typename T>
+		[[nodiscard]] bool Array(std::uint64_t count, std::span<const T>& out) noexcept
+		{
+			const std::size_t aligned = (m_cursor + array_alignment - 1) & ~(array_alignment - 1);
+			if (aligned > m_data.size() || count > (m_data.size() - aligned) / sizeof(T)) return false;
+			out = std::span<const T>(reinterpret_cast<const T*>(m_data.data() + aligned), static_cast<std::size_t>(count));
+			m_cursor = aligned + out.size_bytes();
+			return true;
+		}
+	};
+
+	bool write_material(CacheWriter& writer, const std::filesystem::path& baseDirectory, const Material& material)
+	{
+		MaterialRecord record{};
+		store_vec3(material.ambient, record.ambient);
+		store_vec3(material.diffuse, record.diffuse);
+		store_vec3(material.specular, record.specular);
+		record.shininess = material.shininess;
+		record.opacity = material.opacity;
+		record.bumpMultiplier = material.bumpMultiplier;
+		record.alphaCutoff = material.alphaCutoff;
+		record.illuminationModel = material.illuminationModel;
+		record.alphaMode = static_cast<std::uint8_t>(material.alphaMode);
+		record.textureFormat = static_cast<std::uint8_t>(material.textureFormat);
+		for (std::size_t slot = 0; slot < texture_slots.size(); ++slot)
+		{
+			const auto& texture = material.*texture_slots[slot];
+			if (!texture) continue;
+			// 파일에서 오지 않은 텍스처는 다시 얻을 수 없으므로 이 모델은 캐시하지 않는다.
+			if (texture->GetSourcePath().empty()) return false;
+			record.textureMask |= static_cast<std::uint8_t>(1u << slot);
+		}
+
+		writer.Pod(record);
+		writer.String(material.name);
+		for (std::size_t slot = 0; slot < texture_slots.size(); ++slot)
+		{
+			const auto& texture = material.*texture_slots[slot];
+			if (!texture) continue;
+			writer.Pod(TextureRecord{ static_cast<std::uint8_t>(texture->GetFormat()), static_cast<std::uint8_t>(texture->GetWrapMode()) });
+			writer.String(encode_path(texture->GetSourcePath(), baseDirectory));
+		}
+		return true;
+	}
+
+	bool write_cache_file(const std::filesystem::path& path, const std::filesystem::path& baseDirectory, const Model& model,
+		std::span<const CacheDependency> files, const AccelerationSettings& acceleration)
+	{
+		CacheWriter writer(path);
+		if (!writer.Good()) return false;
+
+		const auto meshes = model.GetMeshes();
+		writer.Pod(FileHeader{ cache_magic, cache_version, static_cast<std::uint32_t>(sizeof(Vertex)),
+			static_cast<std::uint32_t>(files.size()), static_cast<std::uint32_t>(meshes.size()),
+			static_cast<std::uint32_t>(acceleration.type), acceleration.maxLeafTriangles, acceleration.octreeLooseness });
+
+		for (const CacheDependency& file : files)
+		{
+			writer.Pod(DependencyRecord{ file.size, file.writeTime, file.hash });
+			writer.String(encode_path(file.path, baseDirectory));
+		}
+
+		for (const Mesh& mesh : meshes)
+		{
+			// 평탄한 노드 배열을 그대로 기록한다. 복원은 이 구간을 복사 없이 가리킨다.
+			std::span<const AccelerationStructure::Node> nodes;
+			std::span<const unsigned int> nodeIndices;
+			if (mesh.acceleration)
+			{
+				nodes = mesh.acceleration->GetNodes();
+				nodeIndices = mesh.acceleration->GetNodeIndices();
+			}
+
+			const auto vertices = mesh.GetVertices();
+			const auto indices = mesh.GetIndices();
+			MeshRecord record{ vertices.size(), indices.size(), nodes.size(), nodeIndices.size() };
+			store_vec3(mesh.localAABB.min, record.boundsMin);
+			store_vec3(mesh.localAABB.max, record.boundsMax);
+			writer.Pod(record);
+			if (!write_material(writer, baseDirectory, mesh.material)) return false;
+
+			writer.Array(vertices);
+			writer.Array(indices);
+			writer.Array(nodes);
+			writer.Array(nodeIndices);
+		}
+		return writer.Close();
+	}
+
+	// 내용은 같고 수정 시각만 바뀐 의존 파일의 새 기록과 파일 내 위치.
+	struct DependencyRestamp
+	{
+		std::size_t offset;
+		DependencyRecord record;
+	};
+
+	// 기록을 제자리에서 고쳐 다음 로드가 같은 파일을 다시 해시하지 않게 한다. 매핑은
+	// 쓰기 공유로 열려 있고 메시가 가리키는 배열 구간은 건드리지 않는다. 실패해도
+	// 캐시는 여전히 유효하므로 결과를 무시한다.
+	void restamp_dependencies(const std::filesystem::path& cachePath, std::span<const DependencyRestamp> restamps)
+	{
+		std::fstream stream(cachePath, std::ios::binary | std::ios::in | std::ios::out);
+		for (const DependencyRestamp& restamp : restamps)
+		{
+			if (!stream) return;
+			stream.seekp(static_cast<std::streamoff>(restamp.offset));
+			stream.write(reinterpret_cast<const char*>(&restamp.record), sizeof(restamp.record));
+		}
+	}
+
+	struct PendingTexture
+	{
+		std::filesystem::path path;
+		ETextureFormat format;
+		ETextureWrap wrap;
+		std::expected<std::shared_ptr<Texture>, AssetLoadError> result{};
+	};
+
+	struct TextureBinding
+	{
+		Material* material;
+		std::size_t slot;
+		std::size_t texture;	// PendingTexture 인덱스
+	};
+
+	bool read_material(CacheReader& reader, const std::filesystem::path& baseDirectory, Material& material,
+		std::vector<PendingTexture>& textures, std::unordered_map<std::string, std::size_t>& textureIndices,
+		std::vector<TextureBinding>& bindings)
+	{
+		MaterialRecord record;
+		if (!reader.Pod(record) || !reader.String(material.name)) return false;
+		if (record.alphaMode > static_cast<std::uint8_t>(EAlphaMode::Blend)
+			|| record.textureFormat > static_cast<std::uint8_t>(ETextureFormat::BC1))
+			return false;
+
+		material.ambient = load_vec3(record.ambient);
+		material.diffuse = load_vec3(record.diffuse);
+		material.specular = load_vec3(record.specular);
+		material.shininess = record.shininess;
+		material.opacity = record.opacity;
+		material.bumpMultiplier = record.bumpMultiplier;
+		material.alphaCutoff = record.alphaCutoff;
+		material.illuminationModel = record.illuminationModel;
+		material.alphaMode = static_cast<EAlphaMode>(record.alphaMode);
+		material.textureFormat = static_cast<ETextureFormat>(record.textureFormat);
+
+		for (std::size_t slot = 0; slot < texture_slots.size(); ++slot)
+		{
+			if (!(record.textureMask & (1u << slot))) continue;
+			TextureRecord texture;
+			std::string encoded;
+			if (!reader.Pod(texture) || !reader.String(encoded)) return false;
+			if (texture.format > static_cast<std::uint8_t>(ETextureFormat::BC1)
+				|| texture.wrap > static_cast<std::uint8_t>(ETextureWrap::Mirror))
+				return false;
+
+			// 여러 재질이 같은 이미지를 참조하므로 디코드 요청은 한 번만 만든다.
+			std::string key = encoded;
+			key.push_back(static_cast<char>(texture.format));
+			key.push_back(static_cast<char>(texture.wrap));
+			const auto [found, inserted] = textureIndices.try_emplace(std::move(key), textures.size());
+			if (inserted)
+			{
+				textures.push_back(PendingTexture{ decode_path(encoded, baseDirectory),
+					static_cast<ETextureFormat>(texture.format), static_cast<ETextureWrap>(texture.wrap) });
+			}
+			bindings.push_back(TextureBinding{ &material, slot, found->second });
+		}
+		return true;
+	}
+}
+
+std::filesystem::path MeshCache::CachePathFor(const std::filesystem::path& sourcePath)
+{
+	auto cachePath = sourcePath;
+	cachePath.replace_extension(".srmesh");
+	return cachePath;
+}
+
+std::unique_ptr<Model> MeshCache::TryLoad(const std::filesystem::path& sourcePath, const AccelerationSettings& acceleration)
+{
+	const auto cachePath = CachePathFor(sourcePath);
+	std::error_code error;
+	if (!std::filesystem::exists(cachePath, error)) return nullptr;
+	const auto baseDirectory = std::filesystem::absolute(cachePath, error).parent_path();
+	if (error) return nullptr;
+
+	auto mapped = sr::MappedFile::Open(cachePath);
+	if (!mapped) return nullptr;
+	// 모든 메시가 매핑 하나를 공유하고, 마지막 메시가 사라질 때 매핑이 해제된다.
+	const auto storage = std::make_shared<const sr::MappedFile>(std::move(*mapped));
+	CacheReader reader(storage->View());
+
+	FileHeader header;
+	if (!reader.Pod(header) || header.magic != cache_magic || header.version != cache_version
+		|| header.vertexStride != sizeof(Vertex) || header.meshCount > storage->Size() / sizeof(MeshRecord))
+		return nullptr;
+	// 다른 가속 구조로 만든 캐시는 미스로 처리한다. 다시 빌드한 결과가 이 파일을 덮어쓴다.
+	if (header.accelerationType != static_cast<std::uint32_t>(acceleration.type)
+		|| header.maxLeafTriangles != acceleration.maxLeafTriangles
+		|| header.octreeLooseness != acceleration.octreeLooseness)
+		return nullptr;
+
+	// 크기와 수정 시각이 같으면 해시를 다시 구하지 않는다. 시각만 달라진 경우
+	// (복사, 버전 관리 체크아웃)에는 내용 해시로 판단해 불필요한 재파싱을 피하고,
+	// 로드가 끝나면 새 시각을 기록해 다음 로드부터는 해시도 건너뛴다.
+	std::vector<std::filesystem::path> dependencies;
+	std::vector<DependencyRestamp> restamps;
+	for (std::uint32_t i = 0; i < header.dependencyCount; ++i)
+	{
+		DependencyRecord recorded;
+		std::string encoded;
+		const std::size_t recordOffset = reader.Offset();
+		if (!reader.Pod(recorded) || !reader.String(encoded)) return nullptr;
+
+		auto path = decode_path(encoded, baseDirectory);
+		// 첫 항목은 OBJ 원본 자신이다.
+		if (i != 0) dependencies.push_back(path);
+		const DependencyRecord current = stat_file(path);
+		if (current.size != recorded.size) return nullptr;
+		if (current.size == missing_file || current.writeTime == recorded.writeTime) continue;
+		const auto hash = hash_file(path);
+		if (!hash || *hash != recorded.hash) return nullptr;
+		restamps.push_back({ recordOffset, DependencyRecord{ current.size, current.writeTime, *hash } });
+	}
+
+	auto model = std::make_unique<Model>();
+	model->m_meshes.resize(header.meshCount);
+	model->m_dependencies = std::move(dependencies);
+
+	std::vector<PendingTexture> textures;
+	std::unordered_map<std::string, std::size_t> textureIndices;
+	std::vector<TextureBinding> bindings;
+	for (Mesh& mesh : model->m_meshes)
+	{
+		MeshRecord record;
+		if (!reader.Pod(record) || !read_material(reader, baseDirectory, mesh.material, textures, textureIndices, bindings))
+			return nullptr;
+
+		std::span<const Vertex> vertices;
+		std::span<const unsigned int> indices;
+		std::span<const AccelerationStructure::Node> nodes;
+		std::span<const unsigned int> nodeIndices;
+		if (!reader.Array(record.vertexCount, vertices) || !reader.Array(record.indexCount, indices)
+			|| !reader.Array(record.nodeCount, nodes) || !reader.Array(record.nodeIndexCount, nodeIndices))
+			return nullptr;
+
+		// 손상된 캐시가 렌더러에서 정점 배열 밖을 읽지 않도록 인덱스 값을 확인한다.
+		const auto inRange = [count = vertices.size()](unsigned int index) { return index < count; };
+		if (indices.size() % 3 != 0 || !std::ranges::all_of(indices, inRange) || !std::ranges::all_of(nodeIndices, inRange))
+			return nullptr;
+
+		mesh.externalStorage = storage;
+		mesh.externalVertices = vertices;
+		mesh.externalIndices = indices;
+		mesh.localAABB.min = load_vec3(record.boundsMin);
+		mesh.localAABB.max = load_vec3(record.boundsMax);
+		model->m_localAABB.Encapsulate(mesh.localAABB);
+
+		// Restore는 mesh 주소를 보관하므로 m_meshes 크기가 확정된 뒤에 호출한다.
+		if (!nodes.empty())
+		{
+			mesh.acceleration = std::make_unique<AccelerationStructure>();
+			if (!mesh.acceleration->Restore(mesh, acceleration, nodes, nodeIndices)) return nullptr;
+		}
+	}
+
+	tbb::parallel_for(std::size_t{ 0 }, textures.size(), [&textures](std::size_t i) {
+		textures[i].result = TextureLoader::LoadTexture(textures[i].path, textures[i].format, textures[i].wrap);
+	});
+	// 이미지가 사라졌거나 디코드할 수 없으면 원본 경로로 다시 로드해 MTL 줄 번호가
+	// 붙은 정확한 오류나 누락 처리를 그쪽에 맡긴다.
+	for (const PendingTexture& texture : textures)
+	{
+		if (!texture.result || !*texture.result) return nullptr;
+	}
+	for (const TextureBinding& binding : bindings)
+	{
+		binding.material->*texture_slots[binding.slot] = *textures[binding.texture].result;
+	}
+	if (!restamps.empty())
+		restamp_dependencies(cachePath, restamps);
+	model->markComplete();
+	return model;
+}
+
+CacheDependency MeshCache::Stamp(const std::filesystem::path& path)
+{
+	const DependencyRecord record = stat_file(path);
+	if (record.size == missing_file) return { path, missing_file, 0, 0 };
+	const auto hash = hash_file(path);
+	if (!hash) return { path, missing_file, 0, 0 };
+	return { path, record.size, record.writeTime, *hash };
+}
+
+bool MeshCache::Write(const std::filesystem::path& sourcePath, const Model& model,
+	std::span<const CacheDependency> dependencies, const AccelerationSettings& acceleration)
+{
+	const auto cachePath = CachePathFor(sourcePath);
+	std::error_code error;
+	const auto baseDirectory = std::filesystem::absolute(cachePath, error).parent_path();
+	if (error) return false;
+
+	auto temporaryPath = cachePath;
+	temporaryPath += ".tmp";
+	if (!write_cache_file(temporaryPath, baseDirectory, model, dependencies, acceleration))
+	{
+		std::filesystem::remove(temporaryPath, error);
+		return false;
+	}
+
+	// 이전 캐시에서 복원한 메시가 아직 살아 있으면(핫 리로드 전의 모델 등) 이 프로세스가
+	// 그 파일을 매핑하고 있어 교체가 거부될 수 있다. 이때는 이전 캐시가 의존 파일
+	// 검사에서 걸러지므로 매핑이 해제된 뒤의 로드에서 다시 시도된다.
+	std::filesystem::rename(temporaryPath, cachePath, error);
+	if (error)
+	{
+		std::filesystem::remove(temporaryPath, error);
+		return false;
+	}
+	return true;
+}
@@ -0,0 +1,42 @@
+﻿#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <span>
+#include "Graphics/AccelerationSettings.h"
+
+class Model;
+
+// 캐시가 기록하는 의존 파일 하나의 크기/수정 시각/내용 해시.
+struct CacheDependency
+{
+	std::filesystem::path path;
+	std::uint64_t size = 0;		// ~0: 기록 당시 없던 파일 (생기면 무효)
+	std::int64_t writeTime = 0;
+	std::uint64_t hash = 0;
+};
+
+// OBJ/MTL 파싱, 법선 생성, AABB와 가속 구조 빌드 결과를 원본 옆의 바이너리 파일
+// (.srmesh)로 저장하고 다음 실행에서 매핑해 그대로 쓴다. 정점/인덱스/노드/노드
+// 인덱스 배열은 복사하지 않고 Mesh가 매핑된 페이지를 직접 가리킨다.
+class MeshCache
+{
+public:
+	// "model.obj" -> "model.srmesh"
+	[[nodiscard]] static std::filesystem::path CachePathFor(const std::filesystem::path& sourcePath);
+
+	// 캐시가 없거나, 버전/정점 배치/가속 구조 설정이 다르거나, 의존 파일이 바뀌었으면
+	// nullptr을 돌려준다. 호출자는 이때 원본을 다시 파싱한다.
+	[[nodiscard]] static std::unique_ptr<Model> TryLoad(const std::filesystem::path& sourcePath,
+		const AccelerationSettings& acceleration);
+
+	// 파일을 읽기 전에 호출해 현재 상태를 찍는다. 파싱 도중 파일이 바뀌면 기록이
+	// 새 내용을 가리키지 않으므로 다음 로드가 캐시를 버린다. 읽을 수 없는 파일은
+	// 없는 파일로 기록해 다음 로드에서 무효가 되게 한다.
+	[[nodiscard]] static CacheDependency Stamp(const std::filesystem::path& path);
+
+	// dependencies는 원본 OBJ가 첫 항목이고 MTL 등이 뒤따르며, 파싱 전에 Stamp로 찍은 값이다.
+	// 임시 파일에 쓴 뒤 교체하므로 중간에 실패해도 이전 캐시가 깨지지 않는다.
+	static bool Write(const std::filesystem::path& sourcePath, const Model& model,
+		std::span<const CacheDependency> dependencies, const AccelerationSettings& acceleration);
+};
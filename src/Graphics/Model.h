@@ -1,5 +1,9 @@
 ﻿#pragma once
+#include <atomic>
+#include <cstddef>
 #include <expected>
+#include <filesystem>
+#include <memory>
 #include <span>
 #include <vector>
 #include "Graphics/ModelLoader.h"
@@ -11,15 +15,39 @@ class RenderQueue; // 전방 선언
 
 class Model
 {
-	// Loader만 완성된 메시 묶음과 그에 대응하는 모델 AABB를 한 번에 채운다.
+	// Loader만 메시 묶음과 그에 대응하는 모델 AABB를 채운다.
 	// 공개 쓰기 API를 만들지 않아 로드 이후 Model의 불변식을 보존한다.
-	friend std::expected<std::unique_ptr<Model>, AssetLoadError> ModelLoader::LoadOBJ(const std::filesystem::path& filepath);
+	friend class ModelLoader;
+	// 바이너리 캐시는 파싱 없이 같은 불변식을 만족하는 모델을 복원한다.
+	friend class MeshCache;
 
 private:
 	std::vector<Mesh> m_meshes;
-	AABB m_localAABB;
+	AABB m_localAABB;	// IsComplete() 이후에만 유효하다
+	std::vector<std::filesystem::path> m_dependencies;	// OBJ가 참조한 MTL 파일 (없는 파일 포함)
+
+	// 비동기 로드 중 렌더 스레드는 준비 플래그가 선 메시만 읽는다. 플래그는
+	// 메시 목록이 확정된 뒤 만들어지며 이후 m_meshes는 재할당되지 않는다.
+	std::unique_ptr<std::atomic<bool>[]> m_meshReady;
+	std::atomic<bool> m_complete{ false };
+
+	void prepareReadiness() { m_meshReady = std::make_unique<std::atomic<bool>[]>(m_meshes.size()); }
+	void markMeshReady(std::size_t index) noexcept { m_meshReady[index].store(true, std::memory_order_release); }
+	void markComplete()
+	{
+		if (!m_meshReady) prepareReadiness();
+		for (std::size_t i = 0; i < m_meshes.size(); ++i) markMeshReady(i);
+		m_complete.store(true, std::memory_order_release);
+	}
 
 public:
 	[[nodiscard]] std::span<const Mesh> GetMeshes() const noexcept { return std::span<const Mesh>{ m_meshes }; }
 	[[nodiscard]] const AABB& GetLocalAABB() const noexcept { return m_localAABB; }
+	// 이 모델을 다시 만들어야 하는 원본 외 파일. 핫 리로드가 MTL 변경을 모델에 연결한다.
+	[[nodiscard]] std::span<const std::filesystem::path> GetDependencies() const noexcept { return m_dependencies; }
+	[[nodiscard]] bool IsMeshReady(std::size_t index) const noexcept
+	{
+		return m_meshReady && m_meshReady[index].load(std::memory_order_acquire);
+	}
+	[[nodiscard]] bool IsComplete() const noexcept { return m_complete.load(std::memory_order_acquire); }
 };
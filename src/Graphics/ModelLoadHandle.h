@@ -0,0 +1,49 @@
+﻿#pragma once
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <thread>
+#include "Graphics/AccelerationSettings.h"
+#include "Utils/AssetLoadError.h"
+
+class Model;
+
+enum class EModelLoadState : std::uint8_t
+{
+	Loading,	// 백그라운드에서 파싱 또는 메시 후처리 중
+	Ready,		// 모든 메시가 준비됨
+	Failed		// GetError()에 원인이 있다
+};
+
+// ModelLoader::LoadOBJAsync가 돌려주는 진행 중인 로드. 렌더 루프는 매 프레임
+// GetModel()을 조회하고 Model::IsMeshReady()가 참인 메시만 그린다.
+class ModelLoadHandle
+{
+	friend class ModelLoader;
+
+private:
+	std::filesystem::path m_path;
+	AccelerationSettings m_acceleration;
+	std::atomic<std::shared_ptr<Model>> m_model;
+	std::atomic<EModelLoadState> m_state{ EModelLoadState::Loading };
+	AssetLoadError m_error;	// Failed를 release로 기록하기 전에 채운다
+
+	// 마지막에 선언해 가장 먼저 파괴되게 한다. 소멸자가 중단을 요청하고 join하므로
+	// 작업 스레드는 위 멤버가 살아 있는 동안에만 실행된다.
+	std::jthread m_worker;
+
+public:
+	ModelLoadHandle(std::filesystem::path path, const AccelerationSettings& acceleration)
+		: m_path(std::move(path)), m_acceleration(acceleration) {}
+	ModelLoadHandle(const ModelLoadHandle&) = delete;
+	ModelLoadHandle& operator=(const ModelLoadHandle&) = delete;
+
+	[[nodiscard]] const std::filesystem::path& GetPath() const noexcept { return m_path; }
+	[[nodiscard]] const AccelerationSettings& GetAccelerationSettings() const noexcept { return m_acceleration; }
+	[[nodiscard]] EModelLoadState GetState() const noexcept { return m_state.load(std::memory_order_acquire); }
+	// 메시 표가 조립되기 전에는 nullptr이다. 이후에는 로드가 끝날 때까지 같은 모델을 돌려준다.
+	[[nodiscard]] std::shared_ptr<const Model> GetModel() const noexcept { return m_model.load(std::memory_order_acquire); }
+	// GetState() == Failed일 때만 유효하다.
+	[[nodiscard]] const AssetLoadError& GetError() const noexcept { return m_error; }
+};
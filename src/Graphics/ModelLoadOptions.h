@@ -0,0 +1,50 @@
+﻿#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include "Graphics/AccelerationSettings.h"
+
+// 로더 단계별 누적 시간(나노초). 메시 후처리 단계(법선/AABB/가속 구조)는 메시 단위로
+// 병렬 실행되므로 벽시계 시간이 아니라 작업 스레드 시간의 합이다.
+struct ModelLoadProfile
+{
+	std::atomic<std::int64_t> parseNs{ 0 };		// 매핑 + 청크 병렬 파싱 + 속성 병합
+	std::atomic<std::int64_t> dedupNs{ 0 };		// 순차 조립(정점 중복 제거, 면 삼각화)
+	std::atomic<std::int64_t> materialsNs{ 0 };	// mtllib: MTL 파싱 + 텍스처 디코드/포맷 변환
+	std::atomic<std::int64_t> normalsNs{ 0 };
+	std::atomic<std::int64_t> aabbNs{ 0 };
+	std::atomic<std::int64_t> accelerationNs{ 0 };	// 옥트리 또는 BVH 빌드
+
+	// 구간을 재고 소멸 시 해당 카운터에 더한다. 프로파일이 없으면 아무것도 하지 않는다.
+	class Scope
+	{
+	private:
+		std::atomic<std::int64_t>* m_counter;
+		std::chrono::steady_clock::time_point m_start;
+
+	public:
+		Scope(ModelLoadProfile* profile, std::atomic<std::int64_t> ModelLoadProfile::* counter) noexcept
+			: m_counter(profile ? &(profile->*counter) : nullptr)
+			, m_start(profile ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point{})
+		{
+		}
+		~Scope()
+		{
+			if (m_counter)
+				m_counter->fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_start).count(),
+					std::memory_order_relaxed);
+		}
+		Scope(const Scope&) = delete;
+		Scope& operator=(const Scope&) = delete;
+	};
+};
+
+struct ModelLoadOptions
+{
+	// false면 .srmesh 캐시를 읽지도 쓰지도 않는다(벤치마크, 캐시 문제 진단용).
+	bool useCache = true;
+	// nullptr이 아니면 단계별 시간을 누적한다. 호출자가 수명을 책임진다.
+	ModelLoadProfile* profile = nullptr;
+	// 메시마다 만들 컬링 계층 구조. 캐시는 같은 설정으로 만든 파일만 받아들인다.
+	AccelerationSettings acceleration;
+};
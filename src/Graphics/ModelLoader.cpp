@@ -1,22 +1,32 @@
 ﻿#include "Graphics/ModelLoader.h"
 #include <algorithm>
 #include <array>
+#include <bit>
 #include <charconv>
+#include <cmath>
 #include <compare>
-#include <fstream>
-#include <map>
+#include <cstdint>
+#include <memory_resource>
+#include <mutex>
+#include <optional>
 #include <ranges>
+#include <span>
 #include <string_view>
+#include <utility>
 #include <unordered_map>
+#include <vector>
+#include <immintrin.h>
 #include <tbb/blocked_range.h>
-#include <tbb/combinable.h>
 #include <tbb/parallel_for.h>
 
 #include "Graphics/TextureLoader.h"
 #include "Graphics/Model.h"
-#include "Graphics/Octree.h"
+#include "Graphics/AccelerationStructure.h"
 #include "Graphics/Material.h"
+#include "Graphics/MeshCache.h"
+#include "Graphics/ModelLoadHandle.h"
 #include "Math/AABB.h"
+#include "Platform/MappedFile.h"
 
 namespace
 {
@@ -130,125 +140,820 @@ namespace
     {
         return { "Malformed OBJ token: " + std::string(token), path, line };
     }
-}
 
-// OBJ 로더: 파일 경로(확장자 없는 베이스 경로)를 받아 Model 구성
-std::expected<std::unique_ptr<Model>, AssetLoadError> ModelLoader::LoadOBJ(const std::filesystem::path& inputPath)
-{
-    auto filename = inputPath;
-    if (!filename.has_extension())
-        filename += ".obj";
-    std::unique_ptr<Model> outModel = std::make_unique<Model>(); // 출력 모델
-	outModel->m_meshes.reserve(1000); // 초기 용량 예약
+    // ---- 병렬 OBJ 파싱 ----
+    // 파일을 줄 경계에 맞춘 청크로 나누어 각 청크를 독립적으로 파싱한 뒤,
+    // 청크별 속성 수/줄 수의 prefix sum으로 전역 인덱스와 행 번호를 복원한다.
+    // 메시 조립은 usemtl/g 순서와 정점 중복 제거가 파일 순서에 의존하므로 순차로 남긴다.
 
-    std::ifstream file(filename); // .obj 파일 열기
-    if (!file.is_open())
-        return std::unexpected(AssetLoadError{ "Unable to open OBJ file: " + filename.string(), filename });
+    // 청크 하나의 목표 크기. 작은 파일은 한 청크가 되어 순차 경로와 같게 동작한다.
+    constexpr std::size_t obj_chunk_bytes = std::size_t{ 1 } << 20;
 
-    // 텍스처/MTL 상대 경로 기반 디렉터리 계산
-    // 예: "path\to\model" → "path\to\"
-    const auto directoryPath = filename.parent_path();
+    enum class EObjStatement : std::uint8_t
+    {
+        Face,
+        UseMaterial,
+        Group,
+        MaterialLibrary
+    };
 
-    // 파일에서 모든 속성(v, vt, vn)을 임시 버퍼에 읽어들입니다.
-    std::vector<SRMath::vec3> temp_positions; // v
-    std::vector<SRMath::vec2> temp_texcoords; // vt
-    std::vector<SRMath::vec3> temp_normals;   // vn
+    // 파일 순서가 의미를 갖는 문장. v/vt/vn은 순서가 곧 인덱스이므로 청크별
+    // 배열에만 쌓고, 면은 그 시점까지의 속성 수를 기록해 전방 참조를 검사한다.
+    struct ObjStatement
+    {
+        EObjStatement type = EObjStatement::Face;
+        std::uint32_t line = 0;                         // 청크 안에서의 1-based 행 번호
+        std::uint32_t cornerBegin = 0;
+        std::uint32_t cornerCount = 0;
+        std::array<std::uint32_t, 3> attributeCounts{}; // 이 행 직전까지 청크에서 읽은 v, vt, vn 수
+        std::string_view arguments;                     // 매핑된 파일을 가리키며 오류 토큰 복원에도 쓴다
+    };
 
-	temp_positions.reserve(65000); // 초기 용량 예약
-	temp_texcoords.reserve(65000); // 초기 용량 예약
-    temp_normals.reserve(65000);   // 초기 용량 예약
-	
-    // MTL 파일에서 재질을 읽어들입니다.
-	std::unordered_map<std::string, Material> materials;    // MTL 파일에서 읽은 재질들
-	std::string currentMaterialName;                        // 현재 사용 중인 재질 이름
+    struct ObjParseError
+    {
+        std::uint32_t line = 0;
+        std::string_view token;
+    };
 
-	bool newGroupStarted = false; // 새로운 g 태그가 시작되었는지 여부
-    
-    // 정점 중복 제거를 위한 맵
-    // Key: v/vt/vn 인덱스 조합, Value: 최종 정점 버퍼의 인덱스
-    std::map<VertexKey, unsigned int> vertexCache;
+    // 청크 파싱 결과는 로드가 끝나면 통째로 버려지므로 전역 힙 대신 청크별 단조 증가
+    // 아레나에 쌓는다. 청크마다 아레나를 따로 두어 병렬 파싱 중에 잠금이 없고,
+    // 속성은 전역 배열로 모은 직후 먼저 돌려줄 수 있게 문장과 다른 아레나에 둔다.
+    // 아레나가 이동 불가능하므로 청크는 제자리에서만 만든다.
+    struct ObjChunk
+    {
+        std::pmr::monotonic_buffer_resource attributeArena;
+        std::pmr::monotonic_buffer_resource statementArena;
+        std::string_view text;
+        std::pmr::vector<SRMath::vec3> positions{ &attributeArena };
+        std::pmr::vector<SRMath::vec2> texcoords{ &attributeArena };
+        std::pmr::vector<SRMath::vec3> normals{ &attributeArena };
+        std::pmr::vector<VertexKey> corners{ &statementArena };
+        std::pmr::vector<ObjStatement> statements{ &statementArena };
+        std::size_t lineCount = 0;
+        // 청크는 첫 오류에서 파싱을 멈춘다. 앞선 문장은 모두 이 행보다 앞이므로
+        // 조립 단계가 문장을 다 처리한 뒤 보고하면 순차 로더와 같은 첫 오류가 된다.
+        std::optional<ObjParseError> error;
+    };
 
-    std::string line; // 한 줄 버퍼
-    std::size_t lineNumber = 0;
-    
-    // OBJ 파일을 한 줄씩 읽어 파싱
-    while (std::getline(file, line))
+    // 청크 경계를 목표 크기 뒤의 첫 '\n' 다음으로 밀어 한 행이 두 청크에 걸치지 않게 한다.
+    [[nodiscard]] std::vector<ObjChunk> split_obj_chunks(std::string_view text)
     {
-        ++lineNumber;
-        std::string_view arguments = line;
-        const std::string_view prefix = take_token(arguments);
-        if (prefix.empty() || prefix.starts_with('#')) continue;
+        std::vector<std::string_view> ranges;
+        ranges.reserve(text.size() / obj_chunk_bytes + 1);
+        std::size_t begin = 0;
+        while (begin < text.size())
+        {
+            std::size_t end = std::min(begin + obj_chunk_bytes, text.size());
+            if (end < text.size())
+            {
+                const auto newline = text.find('\n', end);
+                end = newline == std::string_view::npos ? text.size() : newline + 1;
+            }
+            ranges.push_back(text.substr(begin, end - begin));
+            begin = end;
+        }
+
+        std::vector<ObjChunk> chunks(ranges.size());
+        for (std::size_t i = 0; i < ranges.size(); ++i)
+            chunks[i].text = ranges[i];
+        return chunks;
+    }
 
-        // 위치 벡터(v)
-        if (prefix == "v")
+    // 줄 하나의 n번째 공백 구분 토큰. 조립 단계 오류에서만 원래 토큰을 복원하는 데 쓴다.
+    [[nodiscard]] std::string_view nth_token(std::string_view arguments, std::size_t index) noexcept
+    {
+        std::string_view token = take_token(arguments);
+        for (std::size_t i = 0; i < index; ++i) token = take_token(arguments);
+        return token;
+    }
+
+    void parse_obj_chunk(ObjChunk& chunk)
+    {
+        std::string_view remaining = chunk.text;
+        std::uint32_t lineNumber = 0;
+        const auto fail = [&chunk, &lineNumber](std::string_view token) {
+            chunk.error = ObjParseError{ lineNumber, token };
+        };
+
+        while (!remaining.empty())
         {
-            auto position = parse_vec3(arguments);
-            if (!position) return std::unexpected(malformed_obj(filename, lineNumber, position.error()));
-            temp_positions.emplace_back(*position);
+            const auto newline = remaining.find('\n');
+            std::string_view arguments = remaining.substr(0, newline);
+            remaining = newline == std::string_view::npos ? std::string_view{} : remaining.substr(newline + 1);
+            ++lineNumber;
+
+            const std::string_view prefix = take_token(arguments);
+            if (prefix.empty() || prefix.starts_with('#')) continue;
+
+            if (prefix == "v")
+            {
+                auto position = parse_vec3(arguments);
+                if (!position) return fail(position.error());
+                chunk.positions.emplace_back(*position);
+            }
+            else if (prefix == "vt")
+            {
+                auto texcoord = parse_vec2(arguments);
+                if (!texcoord) return fail(texcoord.error());
+                chunk.texcoords.emplace_back(*texcoord);
+            }
+            else if (prefix == "vn")
+            {
+                auto normal = parse_vec3(arguments);
+                if (!normal) return fail(normal.error());
+                chunk.normals.emplace_back(*normal);
+            }
+            else if (prefix == "f" || prefix == "usemtl" || prefix == "g" || prefix == "mtllib")
+            {
+                ObjStatement statement;
+                statement.line = lineNumber;
+                statement.attributeCounts = {
+                    static_cast<std::uint32_t>(chunk.positions.size()),
+                    static_cast<std::uint32_t>(chunk.texcoords.size()),
+                    static_cast<std::uint32_t>(chunk.normals.size())
+                };
+                statement.arguments = arguments;
+
+                if (prefix == "f")
+                {
+                    statement.type = EObjStatement::Face;
+                    statement.cornerBegin = static_cast<std::uint32_t>(chunk.corners.size());
+                    std::size_t vertexCount = 0;
+                    while (!arguments.empty())
+                    {
+                        const auto faceToken = take_token(arguments);
+                        if (faceToken.empty()) break;
+
+                        auto key = parse_vertex_key(faceToken);
+                        if (!key) return fail(key.error());
+                        chunk.corners.emplace_back(*key);
+                        ++vertexCount;
+                    }
+
+                    // 코너 수에는 제한이 없다. 조립 단계가 n-gon을 삼각형으로 나눈다.
+                    if (vertexCount < 3) return fail("f");
+                    statement.cornerCount = static_cast<std::uint32_t>(vertexCount);
+                }
+                else if (prefix == "usemtl")
+                {
+                    statement.type = EObjStatement::UseMaterial;
+                    statement.arguments = take_token(arguments);
+                }
+                else if (prefix == "g")
+                {
+                    statement.type = EObjStatement::Group;
+                }
+                else
+                {
+                    statement.type = EObjStatement::MaterialLibrary;
+                    statement.arguments = take_token(arguments);
+                }
+                chunk.statements.push_back(statement);
+            }
         }
+        chunk.lineCount = lineNumber;
+    }
+
+    // v/vt/vn 키 -> 메시 정점 인덱스의 open-addressing 해시 테이블.
+    // std::map은 코너마다 O(log n) 포인터 추적과 노드 할당을 했다. 이 테이블은
+    // 한 배열에서 선형 탐사하고, 메시 그룹이 바뀔 때 세대 번호만 올려 비우므로
+    // 할당/해제가 로드 전체에서 한 번뿐이다.
+    class VertexDedupTable
+    {
+    private:
+        struct Slot
+        {
+            VertexKey key;
+            unsigned int value = 0;
+            std::uint32_t generation = 0;   // 현재 세대와 다르면 빈 슬롯
+        };
+
+        std::pmr::vector<Slot> m_slots;
+        std::size_t m_mask = 0;
+        std::size_t m_size = 0;
+        std::uint32_t m_generation = 1;
 
-        // 텍스처 좌표(vt)
-        else if (prefix == "vt")
+        [[nodiscard]] static std::size_t hash(const VertexKey& key) noexcept
         {
-            auto texcoord = parse_vec2(arguments);
-            if (!texcoord) return std::unexpected(malformed_obj(filename, lineNumber, texcoord.error()));
-            temp_texcoords.emplace_back(*texcoord);
+            // 세 인덱스를 64비트로 섞은 뒤 murmur3 finalizer로 하위 비트까지 퍼뜨린다.
+            std::uint64_t h = static_cast<std::uint32_t>(key.pos_idx) * 0x9E3779B97F4A7C15ull;
+            h ^= static_cast<std::uint32_t>(key.tex_idx) * 0xC2B2AE3D27D4EB4Full;
+            h ^= static_cast<std::uint32_t>(key.nrm_idx) * 0x165667B19E3779F9ull;
+            h ^= h >> 33;
+            h *= 0xFF51AFD7ED558CCDull;
+            h ^= h >> 33;
+            return static_cast<std::size_t>(h);
+        }
 
+        void grow()
+        {
+            std::pmr::vector<Slot> previous = std::exchange(m_slots, std::pmr::vector<Slot>(m_slots.size() * 2, m_slots.get_allocator()));
+            m_mask = m_slots.size() - 1;
+            for (const Slot& slot : previous)
+            {
+                if (slot.generation != m_generation) continue;
+                std::size_t index = hash(slot.key) & m_mask;
+                while (m_slots[index].generation == m_generation) index = (index + 1) & m_mask;
+                m_slots[index] = slot;
+            }
         }
 
-        // 법선 벡터(vn)
-        else if (prefix == "vn")
+    public:
+        // 예상 최대 고유 정점 수로 한 번 할당한다. 적재율을 1/2 이하로 유지해
+        // 선형 탐사 길이를 짧게 둔다.
+        VertexDedupTable(std::size_t expectedVertices, std::pmr::memory_resource* resource)
+            : m_slots(std::bit_ceil(std::max<std::size_t>(expectedVertices * 2, 16)), resource)
         {
-            auto normal = parse_vec3(arguments);
-            if (!normal) return std::unexpected(malformed_obj(filename, lineNumber, normal.error()));
-            temp_normals.emplace_back(*normal);
-            
+            m_mask = m_slots.size() - 1;
         }
 
-        // 머티리얼 라이브러리 참조(mtllib)
-        else if (prefix == "mtllib")
+        // O(1) 비우기. 세대 번호가 한 바퀴 돌면 실제로 지운다.
+        void clear()
         {
-            const std::string mtlFilename(take_token(arguments));
-            const auto mtlPath = directoryPath / mtlFilename;
-            // OBJ의 MTL 참조는 선택 사항이다. 누락된 라이브러리는 기본 재질로 계속 로드한다.
-            if (!std::filesystem::exists(mtlPath))
-                continue;
+            m_size = 0;
+            if (++m_generation == 0)
+            {
+                std::ranges::fill(m_slots, Slot{});
+                m_generation = 1;
+            }
+        }
+
+        // key가 있으면 {기존 값, false}, 없으면 value를 넣고 {value, true}를 돌려준다.
+        [[nodiscard]] std::pair<unsigned int, bool> try_emplace(const VertexKey& key, unsigned int value)
+        {
+            if ((m_size + 1) * 2 > m_slots.size()) grow();
+
+            std::size_t index = hash(key) & m_mask;
+            while (m_slots[index].generation == m_generation)
+            {
+                if (m_slots[index].key == key) return { m_slots[index].value, false };
+                index = (index + 1) & m_mask;
+            }
+            m_slots[index] = Slot{ key, value, m_generation };
+            ++m_size;
+            return { value, true };
+        }
+    };
+
+    // n-gon 면을 삼각형으로 나눈다. 볼록 면은 기존 쿼드와 같은 팬(0, i+1, i+2)으로,
+    // 오목 면은 귀 자르기(ear clipping)로 나눈다. 면마다 다시 할당하지 않도록 작업
+    // 버퍼를 조립 루프 전체에서 재사용한다. 결과는 면 안의 코너 번호 세 개씩이며
+    // 삼각형은 원래 면과 같은 방향(OBJ 순서)이다.
+    class FaceTriangulator
+    {
+    private:
+        // 2D로 투영한 코너 좌표(SoA). 볼록성 검사가 4개씩 SSE로 처리하도록 앞 두 코너를
+        // 끝에 한 번 더 붙여 둔다 (x[n] = x[0], x[n + 1] = x[1]).
+        std::vector<float> m_x;
+        std::vector<float> m_y;
+        std::vector<std::uint32_t> m_prev;      // 귀 자르기 중 남은 코너의 이중 연결 목록
+        std::vector<std::uint32_t> m_next;
+        std::vector<std::uint32_t> m_triangles;
+
+        [[nodiscard]] float turn(std::uint32_t a, std::uint32_t b, std::uint32_t c) const noexcept
+        {
+            return (m_x[b] - m_x[a]) * (m_y[c] - m_y[b]) - (m_y[b] - m_y[a]) * (m_x[c] - m_x[b]);
+        }
+
+        // 면 법선(Newell)의 가장 큰 축을 버려 2D로 투영하고, 면이 반시계가 되도록 부호를 맞춘다.
+        void project(std::span<const SRMath::vec3> positions)
+        {
+            const std::size_t count = positions.size();
+            SRMath::vec3 normal(0.0f, 0.0f, 0.0f);
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                const SRMath::vec3& current = positions[i];
+                const SRMath::vec3& next = positions[(i + 1) % count];
+                normal.x += (current.y - next.y) * (current.z + next.z);
+                normal.y += (current.z - next.z) * (current.x + next.x);
+                normal.z += (current.x - next.x) * (current.y + next.y);
+            }
+
+            const float ax = std::abs(normal.x), ay = std::abs(normal.y), az = std::abs(normal.z);
+            // (u, v) 축과 그 평면에서의 면적 부호를 내는 법선 성분. 순환 순서(y,z), (z,x), (x,y)를
+            // 쓰면 투영 면적의 부호가 버린 축의 법선 성분 부호와 같다.
+            std::size_t u = 0, v = 1;
+            float sign = normal.z;
+            if (ax >= ay && ax >= az) { u = 1; v = 2; sign = normal.x; }
+            else if (ay >= az) { u = 2; v = 0; sign = normal.y; }
+            const float flip = sign < 0.0f ? -1.0f : 1.0f;
+
+            m_x.resize(count + 2);
+            m_y.resize(count + 2);
+            for (std::size_t i = 0; i < count + 2; ++i)
+            {
+                const SRMath::vec3& position = positions[i % count];
+                m_x[i] = position[u] * flip;
+                m_y[i] = position[v];
+            }
+        }
+
+        // 코너마다 (이전 변 x 다음 변)을 4개씩 계산하고 최솟값으로 볼록성을 판정한다.
+        // 반시계로 맞춘 면에서 음수인 코너가 하나라도 있으면 오목이다.
+        [[nodiscard]] bool isConvex(std::size_t count) const noexcept
+        {
+            std::size_t i = 0;
+            __m128 minimum = _mm_set1_ps(0.0f);
+            for (; i + 4 <= count; i += 4)
+            {
+                const __m128 x0 = _mm_loadu_ps(&m_x[i]);
+                const __m128 x1 = _mm_loadu_ps(&m_x[i + 1]);
+                const __m128 x2 = _mm_loadu_ps(&m_x[i + 2]);
+                const __m128 y0 = _mm_loadu_ps(&m_y[i]);
+                const __m128 y1 = _mm_loadu_ps(&m_y[i + 1]);
+                const __m128 y2 = _mm_loadu_ps(&m_y[i + 2]);
+                const __m128 cross = _mm_sub_ps(
+                    _mm_mul_ps(_mm_sub_ps(x1, x0), _mm_sub_ps(y2, y1)),
+                    _mm_mul_ps(_mm_sub_ps(y1, y0), _mm_sub_ps(x2, x1)));
+                minimum = _mm_min_ps(minimum, cross);
+            }
+            alignas(16) float lanes[4];
+            _mm_store_ps(lanes, minimum);
+            float smallest = std::min({ lanes[0], lanes[1], lanes[2], lanes[3] });
+            for (; i < count; ++i)
+                smallest = std::min(smallest, turn(static_cast<std::uint32_t>(i), static_cast<std::uint32_t>(i + 1), static_cast<std::uint32_t>(i + 2)));
+            // 일직선 코너(0)는 팬을 깨뜨리지 않으므로 볼록으로 본다.
+            return smallest >= 0.0f;
+        }
+
+        [[nodiscard]] bool insideTriangle(std::uint32_t a, std::uint32_t b, std::uint32_t c, std::uint32_t p) const noexcept
+        {
+            return turn(a, b, p) >= 0.0f && turn(b, c, p) >= 0.0f && turn(c, a, p) >= 0.0f;
+        }
+
+        // 코너 b(이웃 a, c)를 잘라도 되는지: 볼록이고 남은 오목 코너가 삼각형 안에 없다.
+        [[nodiscard]] bool isEar(std::uint32_t a, std::uint32_t b, std::uint32_t c) const noexcept
+        {
+            if (turn(a, b, c) <= 0.0f) return false;
+            for (std::uint32_t p = m_next[c]; p != a; p = m_next[p])
+            {
+                if (turn(m_prev[p], p, m_next[p]) <= 0.0f && insideTriangle(a, b, c, p)) return false;
+            }
+            return true;
+        }
+
+        void emit(std::uint32_t a, std::uint32_t b, std::uint32_t c)
+        {
+            m_triangles.insert(m_triangles.end(), { a, b, c });
+        }
+
+        void clipEars(std::uint32_t count)
+        {
+            m_prev.resize(count);
+            m_next.resize(count);
+            for (std::uint32_t i = 0; i < count; ++i)
+            {
+                m_prev[i] = (i + count - 1) % count;
+                m_next[i] = (i + 1) % count;
+            }
+
+            std::uint32_t current = 0;
+            std::uint32_t remaining = count;
+            std::uint32_t sinceLastEar = 0;
+            while (remaining > 3)
+            {
+                const std::uint32_t a = m_prev[current];
+                const std::uint32_t c = m_next[current];
+                if (isEar(a, current, c))
+                {
+                    emit(a, current, c);
+                    m_next[a] = c;
+                    m_prev[c] = a;
+                    --remaining;
+                    sinceLastEar = 0;
+                    current = c;
+                    continue;
+                }
+
+                current = c;
+                // 자기 교차나 중복 코너로 귀가 더 없으면 남은 다각형을 팬으로 닫는다.
+                if (++sinceLastEar > remaining)
+                {
+                    for (std::uint32_t b = m_next[current]; m_next[b] != current; b = m_next[b])
+                        emit(current, b, m_next[b]);
+                    return;
+                }
+            }
+            emit(m_prev[current], current, m_next[current]);
+        }
+
+    public:
+        [[nodiscard]] std::span<const std::uint32_t> Triangulate(std::span<const SRMath::vec3> positions)
+        {
+            const auto count = static_cast<std::uint32_t>(positions.size());
+            m_triangles.clear();
+            if (count < 3) return {};
+
+            bool convex = count == 3;
+            if (count == 4)
+            {
+                // 가장 흔한 쿼드는 투영 없이 판정한다. 대각선 0-2로 나눈 두 삼각형의
+                // 법선이 같은 쪽을 향하면 팬이 면을 정확히 덮는다.
+                const SRMath::vec3 diagonal = positions[2] - positions[0];
+                const SRMath::vec3 first = SRMath::cross(positions[1] - positions[0], diagonal);
+                const SRMath::vec3 second = SRMath::cross(diagonal, positions[3] - positions[0]);
+                convex = SRMath::dot(first, second) >= 0.0f;
+            }
+            if (!convex)
+            {
+                project(positions);
+                convex = isConvex(count);
+            }
+
+            if (convex)
+            {
+                for (std::uint32_t i = 1; i + 1 < count; ++i)
+                    emit(0, i, i + 1);
+            }
+            else
+            {
+                clipEars(count);
+            }
+            return m_triangles;
+        }
+    };
+
+    // 청크별 속성 배열을 prefix sum 위치에 병렬로 이어 붙인다. 옮긴 청크 배열은
+    // 비워 두고, 세 속성을 모두 모은 뒤 청크의 속성 아레나를 한 번에 해제한다.
+    template <typename Attribute>
+    [[nodiscard]] std::pmr::vector<Attribute> gather_attributes(std::span<ObjChunk> chunks,
+        std::span<const std::size_t> offsets, std::pmr::vector<Attribute> ObjChunk::* member,
+        std::pmr::memory_resource* resource)
+    {
+        std::pmr::vector<Attribute> merged(offsets.back(), resource);
+        tbb::parallel_for(std::size_t{ 0 }, chunks.size(), [&](std::size_t i) {
+            std::pmr::vector<Attribute>& local = chunks[i].*member;
+            std::ranges::copy(local, merged.begin() + static_cast<std::ptrdiff_t>(offsets[i]));
+            std::pmr::vector<Attribute>(local.get_allocator()).swap(local);
+        });
+        return merged;
+    }
+
+    // 조립 전에 문장만 훑어 메시마다 최종 인덱스 수를 센다. 메시 경계 규칙은 조립 단계와
+    // 같다(첫 면, g 뒤의 첫 면, 재질이 바뀐 뒤의 첫 면). n-gon은 팬이든 귀 자르기든
+    // 항상 n - 2개의 삼각형이 되므로 인덱스 버퍼를 정확한 크기로 예약할 수 있다.
+    [[nodiscard]] std::pmr::vector<std::size_t> count_mesh_indices(std::span<const ObjChunk> chunks,
+        std::pmr::memory_resource* resource)
+    {
+        std::pmr::vector<std::size_t> counts(resource);
+        std::string_view currentMaterial;
+        std::string_view meshMaterial;
+        bool newGroupStarted = false;
+        for (const ObjChunk& chunk : chunks)
+        {
+            for (const ObjStatement& statement : chunk.statements)
+            {
+                if (statement.type == EObjStatement::UseMaterial)
+                {
+                    currentMaterial = statement.arguments;
+                }
+                else if (statement.type == EObjStatement::Group)
+                {
+                    newGroupStarted = true;
+                }
+                else if (statement.type == EObjStatement::Face)
+                {
+                    if (counts.empty() || meshMaterial != currentMaterial || newGroupStarted)
+                    {
+                        newGroupStarted = false;
+                        meshMaterial = currentMaterial;
+                        counts.push_back(0);
+                    }
+                    counts.back() += (std::size_t{ statement.cornerCount } - 2) * 3;
+                }
+            }
+        }
+        return counts;
+    }
 
-            // 디렉터리 기준 경로를 사용하여 MTL 파싱
-            auto loadedMaterials = TextureLoader::LoadMTLFile(mtlPath);
-            if (!loadedMaterials)
-                return std::unexpected(std::move(loadedMaterials.error()));
-            materials = std::move(*loadedMaterials);
+    // 메시가 닫히면 고유 정점 수가 확정되므로 정점 버퍼를 정확한 크기로 한 번 할당하고
+    // 키가 가리키는 속성을 병렬로 채운다. 인덱스 범위는 키를 등록할 때 이미 검사했다.
+    void build_mesh_vertices(Mesh& mesh, std::span<const VertexKey> keys,
+        std::span<const SRMath::vec3> positions, std::span<const SRMath::vec2> texcoords,
+        std::span<const SRMath::vec3> normals)
+    {
+        mesh.vertices.resize(keys.size());
+        tbb::parallel_for(tbb::blocked_range<std::size_t>(0, keys.size(), 4096),
+            [&](const tbb::blocked_range<std::size_t>& range) {
+            for (std::size_t i = range.begin(); i != range.end(); ++i)
+            {
+                const VertexKey& key = keys[i];
+                Vertex& vertex = mesh.vertices[i];
+                vertex.position = positions[static_cast<std::size_t>(key.pos_idx)];
+                if (key.tex_idx >= 0)
+                    vertex.texcoord = texcoords[static_cast<std::size_t>(key.tex_idx)];
+                if (key.nrm_idx >= 0)
+                    vertex.normal = normals[static_cast<std::size_t>(key.nrm_idx)];
+            }
+        });
+    }
+    // OBJ 로더는 확장자 없는 베이스 경로도 받는다 (예: "assets/teapot").
+    std::filesystem::path resolve_obj_path(const std::filesystem::path& inputPath)
+    {
+        auto filename = inputPath;
+        if (!filename.has_extension())
+            filename += ".obj";
+        return filename;
+    }
+
+    // 같은 OBJ를 가리키는 GameObject들이 로드 하나(모델, 가속 구조, 텍스처 한 벌)를 공유하게 한다.
+    // 텍스처 캐시처럼 약한 참조만 보관하므로 마지막 인스턴스가 사라지면 모델도 해제된다.
+    // 가속 구조 설정이 다르면 다른 모델이다.
+    class ModelHandleCache
+    {
+    private:
+        struct Key
+        {
+            std::filesystem::path path;
+            AccelerationSettings acceleration;
+
+            [[nodiscard]] bool operator==(const Key&) const = default;
+        };
+
+        struct KeyHash
+        {
+            [[nodiscard]] std::size_t operator()(const Key& key) const noexcept
+            {
+                // Win32에서는 size_t가 32비트라서 키를 64비트로 만든 뒤 섞어서 접는다.
+                const std::uint64_t settings = ((static_cast<std::uint64_t>(key.acceleration.type) << 32)
+                        | key.acceleration.maxLeafTriangles)
+                    ^ (static_cast<std::uint64_t>(std::bit_cast<std::uint32_t>(key.acceleration.octreeLooseness)) << 16);
+                const std::uint64_t mixed = settings * 0x9E3779B97F4A7C15ull;
+                return std::filesystem::hash_value(key.path) ^ static_cast<std::size_t>(mixed ^ (mixed >> 32));
+            }
+        };
+
+        std::mutex m_mutex;
+        std::unordered_map<Key, std::weak_ptr<ModelLoadHandle>, KeyHash> m_entries;
+
+    public:
+        template <typename StartLoad>
+        [[nodiscard]] std::shared_ptr<ModelLoadHandle> FindOrStart(const std::filesystem::path& path,
+            const AccelerationSettings& acceleration, StartLoad&& startLoad)
+        {
+            std::error_code error;
+            auto canonical = std::filesystem::weakly_canonical(path, error);
+            const Key key{ error ? path.lexically_normal() : std::move(canonical), acceleration };
+
+            const std::lock_guard lock(m_mutex);
+            std::erase_if(m_entries, [](const auto& entry) { return entry.second.expired(); });
+
+            std::weak_ptr<ModelLoadHandle>& entry = m_entries[key];
+            // 실패한 로드는 공유하지 않는다. 파일을 고친 뒤 만든 인스턴스는 다시 읽는다.
+            if (auto existing = entry.lock(); existing && existing->GetState() != EModelLoadState::Failed)
+                return existing;
+
+            auto handle = startLoad();
+            entry = handle;
+            return handle;
         }
-        // 머티리얼 선택(usemtl)
-        else if (prefix == "usemtl")
+    };
+
+    [[nodiscard]] ModelHandleCache& model_handle_cache()
+    {
+        static ModelHandleCache cache;
+        return cache;
+    }
+
+    // 면 법선을 정점에 누적해 부드러운 법선(Smooth Normal)을 만든다. 스캔 데이터처럼
+    // 메시 하나가 파일 전체인 경우에도 모든 코어를 쓰도록 두 단계로 나눈다.
+    // 1) 삼각형마다 면 법선을 병렬로 구한다.
+    // 2) 정점 → 삼각형 인접 목록(CSR)을 따라 정점마다 면 법선을 모은다.
+    // 정점은 자기 합만 쓰므로 원자 연산이 없고, 인접 삼각형을 오름차순으로 더해
+    // 삼각형 순서대로 누적하던 순차 구현과 비트 단위로 같은 결과가 나온다.
+    void generate_smooth_normals(Mesh& mesh)
+    {
+        const std::size_t triangleCount = mesh.indices.size() / 3;
+        const std::size_t vertexCount = mesh.vertices.size();
+
+        std::vector<SRMath::vec3> faceNormals(triangleCount);
+        tbb::parallel_for(tbb::blocked_range<std::size_t>(0, triangleCount),
+            [&mesh, &faceNormals](const tbb::blocked_range<std::size_t>& range) {
+            for (std::size_t triangle = range.begin(); triangle != range.end(); ++triangle)
+            {
+                const SRMath::vec3& v0 = mesh.vertices[mesh.indices[triangle * 3]].position;
+                const SRMath::vec3& v1 = mesh.vertices[mesh.indices[triangle * 3 + 1]].position;
+                const SRMath::vec3& v2 = mesh.vertices[mesh.indices[triangle * 3 + 2]].position;
+
+                // 렌더링 인덱스는 화면 컬링을 위해 winding을 반전해 저장된다.
+                // 자동 법선은 원본 OBJ의 바깥쪽을 향하도록 교차곱 순서를 반대로 사용한다.
+                const SRMath::vec3 face_normal = SRMath::cross(v2 - v0, v1 - v0);
+
+                // 0벡터 방지 후 정규화
+                faceNormals[triangle] = SRMath::length(face_normal) > 1e-6f
+                    ? SRMath::normalize(face_normal)
+                    : SRMath::vec3(0.0f, 0.0f, 0.0f);
+            }
+        });
+
+        // 정점별 인접 삼각형 수를 세고 prefix sum으로 구간을 정한 뒤 삼각형 순서대로 채운다.
+        // 정수 카운트와 복사뿐이라 순차로 두어도 면 법선/정규화 단계보다 훨씬 가볍다.
+        std::vector<std::uint32_t> incidentOffsets(vertexCount + 1, 0);
+        for (const unsigned int index : mesh.indices) ++incidentOffsets[index + 1];
+        for (std::size_t vertex = 0; vertex < vertexCount; ++vertex)
+            incidentOffsets[vertex + 1] += incidentOffsets[vertex];
+
+        std::vector<std::uint32_t> incidentTriangles(incidentOffsets.back());
+        std::vector<std::uint32_t> cursor(incidentOffsets.begin(), incidentOffsets.end() - 1);
+        for (std::size_t corner = 0; corner < triangleCount * 3; ++corner)
+            incidentTriangles[cursor[mesh.indices[corner]]++] = static_cast<std::uint32_t>(corner / 3);
+
+        tbb::parallel_for(tbb::blocked_range<std::size_t>(0, vertexCount),
+            [&](const tbb::blocked_range<std::size_t>& range) {
+            for (std::size_t vertex = range.begin(); vertex != range.end(); ++vertex)
+            {
+                SRMath::vec3 normal(0.0f, 0.0f, 0.0f);
+                for (std::uint32_t k = incidentOffsets[vertex]; k != incidentOffsets[vertex + 1]; ++k)
+                    normal = normal + faceNormals[incidentTriangles[k]];
+
+                const float length = SRMath::length(normal);
+                mesh.vertices[vertex].normal = length > 1e-6f
+                    ? SRMath::normalize(normal)
+                    : SRMath::vec3(0.0f, 1.0f, 0.0f); // 기본 위쪽 방향
+            }
+        });
+    }
+
+    // 조립이 끝난 메시 하나의 후처리(법선 생성, AABB 계산, 가속 구조 빌드).
+    // 메시끼리 공유하는 상태가 없어 메시 단위로 병렬 실행하고 끝난 순서대로 공개한다.
+    void finalize_mesh(Mesh& mesh, const AccelerationSettings& acceleration, ModelLoadProfile* profile)
+    {
         {
-            currentMaterialName = std::string(take_token(arguments));
+            const ModelLoadProfile::Scope scope(profile, &ModelLoadProfile::normalsNs);
+            // OBJ의 모든 정점에 유효한 vn이 있는지 확인한다.
+            // 하나라도 빠졌다면 일관된 조명을 위해 전체 메시 법선을 생성한다.
+            const bool hasNormals = std::ranges::all_of(mesh.vertices, [](const Vertex& vertex) {
+                return SRMath::dot(vertex.normal, vertex.normal) > 1e-12f;
+                });
+
+            // If there is no Normal vector in OBJ File
+            if (!hasNormals)
+                generate_smooth_normals(mesh);
         }
-        // 그룹 시작(g)
-        else if (prefix == "g")
+
+        // 메시 AABB 계산
         {
-            // 새로운 g 태그를 만나면 플래그를 설정
-            newGroupStarted = true;
+            const ModelLoadProfile::Scope scope(profile, &ModelLoadProfile::aabbNs);
+            mesh.localAABB = AABB::CreateFromMesh(mesh);
         }
-        // 면(face) 정의(f)
-        else if(prefix == "f")
+
+        // 옥트리 또는 BVH 생성 및 빌드 (가시화/프러스텀 컬링 최적화)
+        const ModelLoadProfile::Scope scope(profile, &ModelLoadProfile::accelerationNs);
+        mesh.acceleration = std::make_unique<AccelerationStructure>();
+        mesh.acceleration->Build(mesh, acceleration);
+    }
+}
+
+// OBJ 파싱과 메시 조립: 후처리 전의 메시(정점, 인덱스, 재질)까지 채운다.
+// 모델의 m_dependencies에는 캐시 무효화와 핫 리로드에 쓰는 MTL 경로가 쌓인다.
+std::expected<std::unique_ptr<Model>, AssetLoadError> ModelLoader::parseOBJ(const std::filesystem::path& filename,
+    ModelLoadProfile* profile, std::vector<CacheDependency>* cacheDependencies)
+{
+    // 캐시에는 파싱한 내용이 아니라 파싱 전의 상태를 기록한다. 파싱 중 저장된
+    // 파일은 새 시각이 기록되지 않으므로 다음 로드에서 다시 파싱된다.
+    if (cacheDependencies)
+        cacheDependencies->push_back(MeshCache::Stamp(filename));
+
+    std::optional<ModelLoadProfile::Scope> phase(std::in_place, profile, &ModelLoadProfile::parseNs);
+    std::unique_ptr<Model> outModel = std::make_unique<Model>(); // 출력 모델
+
+    // 파일을 매핑해 한 줄씩 string으로 복사하지 않는다. 매핑은 함수가 끝날
+    // 때까지 살아 있으므로 파싱 결과의 string_view가 그대로 유효하다.
+    auto mappedFile = sr::MappedFile::Open(filename);
+    if (!mappedFile)
+        return std::unexpected(AssetLoadError{ "Unable to open OBJ file: " + filename.string(), filename });
+
+    // 텍스처/MTL 상대 경로 기반 디렉터리 계산
+    // 예: "path\to\model" → "path\to\"
+    const auto directoryPath = filename.parent_path();
+
+    // 로드 동안만 쓰는 조립 버퍼(전역 속성 배열, 중복 제거 표, 면 작업 버퍼, 메시 계획)는
+    // 이 아레나에서 잘라 쓰고 함수가 끝날 때 한 번에 돌려준다. 최종 메시 버퍼만 전역 힙에 남는다.
+    std::pmr::monotonic_buffer_resource loadArena;
+
+    // 1) 청크 병렬 파싱: 속성, 문장, 면 코너, 첫 오류를 청크마다 모은다.
+    std::vector<ObjChunk> chunks = split_obj_chunks(mappedFile->View());
+    tbb::parallel_for(std::size_t{ 0 }, chunks.size(), [&chunks](std::size_t i) {
+        parse_obj_chunk(chunks[i]);
+    });
+
+    // 2) prefix sum: 청크마다 전역 v/vt/vn 시작 인덱스와 시작 행 번호를 구한다.
+    //    오류가 난 청크 뒤의 값은 쓰이지 않는다.
+    std::vector<std::size_t> positionOffsets(chunks.size() + 1, 0);
+    std::vector<std::size_t> texcoordOffsets(chunks.size() + 1, 0);
+    std::vector<std::size_t> normalOffsets(chunks.size() + 1, 0);
+    std::vector<std::size_t> lineOffsets(chunks.size() + 1, 0);
+    for (std::size_t i = 0; i < chunks.size(); ++i)
+    {
+        positionOffsets[i + 1] = positionOffsets[i] + chunks[i].positions.size();
+        texcoordOffsets[i + 1] = texcoordOffsets[i] + chunks[i].texcoords.size();
+        normalOffsets[i + 1] = normalOffsets[i] + chunks[i].normals.size();
+        lineOffsets[i + 1] = lineOffsets[i] + chunks[i].lineCount;
+    }
+
+    // 파일에서 모든 속성(v, vt, vn)을 전역 버퍼로 모읍니다.
+    const std::pmr::vector<SRMath::vec3> temp_positions = gather_attributes(std::span(chunks), std::span<const std::size_t>(positionOffsets), &ObjChunk::positions, &loadArena); // v
+    const std::pmr::vector<SRMath::vec2> temp_texcoords = gather_attributes(std::span(chunks), std::span<const std::size_t>(texcoordOffsets), &ObjChunk::texcoords, &loadArena); // vt
+    const std::pmr::vector<SRMath::vec3> temp_normals = gather_attributes(std::span(chunks), std::span<const std::size_t>(normalOffsets), &ObjChunk::normals, &loadArena);      // vn
+    for (ObjChunk& chunk : chunks)
+        chunk.attributeArena.release();
+    phase.emplace(profile, &ModelLoadProfile::dedupNs);
+	
+    // MTL 파일에서 재질을 읽어들입니다.
+	std::unordered_map<std::string, Material> materials;    // MTL 파일에서 읽은 재질들
+	std::string_view currentMaterialName;                   // 현재 사용 중인 재질 이름 (매핑된 파일을 가리킨다)
+
+	bool newGroupStarted = false; // 새로운 g 태그가 시작되었는지 여부
+    
+    // 메시마다 최종 인덱스 수. 메시 표와 인덱스 버퍼를 재할당 없이 채운다.
+    const std::pmr::vector<std::size_t> meshIndexCounts = count_mesh_indices(std::span<const ObjChunk>(chunks), &loadArena);
+    outModel->m_meshes.reserve(meshIndexCounts.size());
+
+    // 정점 중복 제거를 위한 해시 테이블
+    // Key: v/vt/vn 인덱스 조합, Value: 최종 정점 버퍼의 인덱스
+    // 테이블은 메시마다 비워지므로 가장 큰 메시만 담으면 된다. 그 메시의 고유 정점은
+    // 코너 수(인덱스 수 이하)를 넘지 않고, 매끈한 메시에서는 위치 수와 비슷하다.
+    // 둘 중 작은 값으로 예약하고 UV 이음매가 많은 메시는 grow가 처리한다.
+    const std::size_t largestMeshIndices = meshIndexCounts.empty() ? 0 : std::ranges::max(meshIndexCounts);
+    VertexDedupTable vertexCache(std::min(largestMeshIndices, temp_positions.size()), &loadArena);
+
+    // 현재 메시의 고유 정점 키(정점 번호 순). 메시가 닫힐 때 정점 버퍼로 옮긴다.
+    std::pmr::vector<VertexKey> meshVertexKeys(&loadArena);
+    const auto closeMesh = [&](Mesh& mesh) {
+        build_mesh_vertices(mesh, meshVertexKeys, temp_positions, temp_texcoords, temp_normals);
+        meshVertexKeys.clear();
+    };
+
+    // 면 단위 작업 버퍼. CAD 데이터처럼 n-gon이 많아도 면마다 할당하지 않는다.
+    std::pmr::vector<unsigned int> faceIndices(&loadArena);
+    std::pmr::vector<SRMath::vec3> facePositions(&loadArena);
+    FaceTriangulator triangulator;
+
+    // 3) 순차 조립: 문장을 파일 순서대로 재생한다.
+    for (std::size_t chunkIndex = 0; chunkIndex < chunks.size(); ++chunkIndex)
+    {
+        const ObjChunk& chunk = chunks[chunkIndex];
+        for (const ObjStatement& statement : chunk.statements)
         {
+            const std::size_t lineNumber = lineOffsets[chunkIndex] + statement.line;
+
+            // 머티리얼 라이브러리 참조(mtllib)
+            if (statement.type == EObjStatement::MaterialLibrary)
+            {
+                const std::string mtlFilename(statement.arguments);
+                const auto mtlPath = directoryPath / mtlFilename;
+                // 없던 MTL이 나중에 생겨도 캐시가 무효화되도록 존재 여부와 무관하게 기록한다.
+                outModel->m_dependencies.push_back(mtlPath);
+                if (cacheDependencies)
+                    cacheDependencies->push_back(MeshCache::Stamp(mtlPath));
+                // OBJ의 MTL 참조는 선택 사항이다. 누락된 라이브러리는 기본 재질로 계속 로드한다.
+                if (!std::filesystem::exists(mtlPath))
+                    continue;
+
+                // 디렉터리 기준 경로를 사용하여 MTL 파싱. 텍스처 디코드가 섞여 있으므로
+                // 조립 시간과 따로 잰다.
+                phase.emplace(profile, &ModelLoadProfile::materialsNs);
+                auto loadedMaterials = TextureLoader::LoadMTLFile(mtlPath);
+                phase.emplace(profile, &ModelLoadProfile::dedupNs);
+                if (!loadedMaterials)
+                    return std::unexpected(std::move(loadedMaterials.error()));
+                materials = std::move(*loadedMaterials);
+                continue;
+            }
+            // 머티리얼 선택(usemtl)
+            if (statement.type == EObjStatement::UseMaterial)
+            {
+                currentMaterialName = statement.arguments;
+                continue;
+            }
+            // 그룹 시작(g)
+            if (statement.type == EObjStatement::Group)
+            {
+                // 새로운 g 태그를 만나면 플래그를 설정
+                newGroupStarted = true;
+                continue;
+            }
+
+            // 면(face) 정의(f)
 			// 새로운 메시 그룹이 시작되었거나, 현재 메시가 없거나, 머티리얼이 바뀐 경우
             if (outModel->m_meshes.empty()
                 || outModel->m_meshes.back().material.name != currentMaterialName
                 || newGroupStarted)
             {
 				newGroupStarted = false; // 새로운 그룹 시작 플래그 초기화
-                // 새로운 메시 그룹이 시작될 때 vertexCache 초기화 ---
+                // 새로운 메시 그룹이 시작될 때 이전 메시의 정점 버퍼를 확정하고 vertexCache 초기화 ---
+                if (!outModel->m_meshes.empty())
+                    closeMesh(outModel->m_meshes.back());
                 vertexCache.clear();
 
                 // 모델에 새로운 메시 추가 및 currentMesh 포인터 갱신
                 outModel->m_meshes.emplace_back();
                 auto& newMesh = outModel->m_meshes.back();
+                newMesh.indices.reserve(meshIndexCounts[outModel->m_meshes.size() - 1]);
 
                 // 현재 머티리얼 이름으로 머티리얼 할당 (없으면 기본값 / 콜론 분리 폴백)
-                if (const auto material = materials.find(currentMaterialName); material != materials.end())
+                const std::string materialName(currentMaterialName);
+                if (const auto material = materials.find(materialName); material != materials.end())
                 {
                     // C++17 if-initializer는 조회 iterator의 수명을 분기 안으로
                     // 제한하고 operator[]의 불필요한 두 번째 해시 탐색을 없앤다.
@@ -256,12 +961,12 @@ std::expected<std::unique_ptr<Model>, AssetLoadError> ModelLoader::LoadOBJ(const
                 }
                 else
                 {
-                    size_t colon_pos = currentMaterialName.find_last_of(":");
+                    size_t colon_pos = materialName.find_last_of(":");
 
                     if (colon_pos != std::string::npos)
                     {
                         // 콜론 뒤의 부분 문자열을 잘라냅니다. (예: "Iron_man_leg:red" -> "red")
-                        std::string baseMaterialName = currentMaterialName.substr(colon_pos + 1);
+                        std::string baseMaterialName = materialName.substr(colon_pos + 1);
 
                         auto fallback_it = materials.find(baseMaterialName);
                         if (fallback_it != materials.end())
@@ -283,176 +988,175 @@ std::expected<std::unique_ptr<Model>, AssetLoadError> ModelLoader::LoadOBJ(const
                 }
 
                 // 최근 머테리얼 이름을 현재 매시의 머테리얼 이름으로 변경
-                newMesh.material.name = currentMaterialName;
+                newMesh.material.name = materialName;
             }
 
 			auto& meshToAddTo = outModel->m_meshes.back();
-            std::size_t vertexCount = 0;
-            std::array<unsigned int, 4> faceIndices{}; // 기존 기능과 동일하게 삼각형/쿼드 지원
+            faceIndices.resize(statement.cornerCount);
 
-            while (!arguments.empty() && vertexCount < faceIndices.size())
-            {
-                const auto faceToken = take_token(arguments);
-                if (faceToken.empty()) break;
+            // 청크 안의 속성 수를 전역 인덱스로 옮겨 "이 행 이전에 정의된 속성만"
+            // 참조할 수 있다는 순차 로더의 계약을 그대로 검사한다.
+            const std::size_t positionCount = positionOffsets[chunkIndex] + statement.attributeCounts[0];
+            const std::size_t texcoordCount = texcoordOffsets[chunkIndex] + statement.attributeCounts[1];
+            const std::size_t normalCount = normalOffsets[chunkIndex] + statement.attributeCounts[2];
 
-                auto key = parse_vertex_key(faceToken);
-                if (!key)
-                {
-                    // 로더가 MessageBox를 직접 띄우던 UI 결합을 제거했다. 오류는
-                    // expected로 Framework까지 전달되어 한 곳에서 사용자 메시지가 된다.
-                    return std::unexpected(malformed_obj(filename, lineNumber, key.error()));
-                }
+            for (std::uint32_t corner = 0; corner < statement.cornerCount; ++corner)
+            {
+                const VertexKey& key = chunk.corners[statement.cornerBegin + corner];
+                const auto invalidCorner = [&] {
+                    return std::unexpected(malformed_obj(filename, lineNumber, nth_token(statement.arguments, corner)));
+                };
 
-                if (static_cast<std::size_t>(key->pos_idx) >= temp_positions.size())
-                {
-                    return std::unexpected(malformed_obj(filename, lineNumber, faceToken));
-                }
+                if (static_cast<std::size_t>(key.pos_idx) >= positionCount)
+                    return invalidCorner();
 
-                // 동일 v/vt/vn 조합이 이미 생성된 적이 있으면 캐시 재사용
-                auto it = vertexCache.find(*key);
-                if (it != vertexCache.end())
+                // 동일 v/vt/vn 조합이 이미 생성된 적이 있으면 캐시 재사용.
+                // 새 정점은 키만 기록하고 메시가 닫힐 때 정확한 크기의 버퍼로 만든다.
+                const auto nextIndex = static_cast<unsigned int>(meshVertexKeys.size());
+                const auto [vertexIndex, inserted] = vertexCache.try_emplace(key, nextIndex);
+                faceIndices[corner] = vertexIndex;
+                if (inserted)
                 {
-                    faceIndices[vertexCount] = it->second;
+                    if (key.tex_idx >= 0 && static_cast<std::size_t>(key.tex_idx) >= texcoordCount)
+                        return invalidCorner();
+                    if (key.nrm_idx >= 0 && static_cast<std::size_t>(key.nrm_idx) >= normalCount)
+                        return invalidCorner();
+                    meshVertexKeys.push_back(key);
                 }
-                else
-                {
-                    Vertex newVertex{};
-                    newVertex.position = temp_positions[static_cast<std::size_t>(key->pos_idx)];
-                    if (key->tex_idx >= 0)
-                    {
-                        if (static_cast<std::size_t>(key->tex_idx) >= temp_texcoords.size())
-                            return std::unexpected(malformed_obj(filename, lineNumber, faceToken));
-                        newVertex.texcoord = temp_texcoords[static_cast<std::size_t>(key->tex_idx)];
-                    }
-                    if (key->nrm_idx >= 0)
-                    {
-                        if (static_cast<std::size_t>(key->nrm_idx) >= temp_normals.size())
-                            return std::unexpected(malformed_obj(filename, lineNumber, faceToken));
-                        newVertex.normal = temp_normals[static_cast<std::size_t>(key->nrm_idx)];
-                    }
-
-                    meshToAddTo.vertices.emplace_back(newVertex);
-                    const auto newIndex = static_cast<unsigned int>(meshToAddTo.vertices.size() - 1);
-                    vertexCache.emplace(*key, newIndex);
-                    faceIndices[vertexCount] = newIndex;
-                }
-                ++vertexCount;
             }
 
-            // 이 renderer의 고정 face buffer는 삼각형/쿼드 계약이다. 과거에는
-            // 다섯 번째 이후 정점을 조용히 버려 손상된 geometry를 만들었으므로
-            // 지원하지 않는 n-gon을 행 번호가 있는 오류로 명시한다.
-            if (!trim_left(arguments).empty())
+            // 렌더링 인덱스는 OBJ 순서 (a, b, c)를 (a, c, b)로 뒤집어 저장한다.
+            if (statement.cornerCount == 3)
             {
-                return std::unexpected(
-                    malformed_obj(filename, lineNumber, "face has more than 4 vertices"));
+                meshToAddTo.indices.insert(meshToAddTo.indices.end(), { faceIndices[0], faceIndices[2], faceIndices[1] });
+                continue;
             }
 
-            if (vertexCount < 3)
+            facePositions.clear();
+            for (std::uint32_t corner = 0; corner < statement.cornerCount; ++corner)
             {
-                return std::unexpected(malformed_obj(filename, lineNumber, "f"));
+                const VertexKey& key = chunk.corners[statement.cornerBegin + corner];
+                facePositions.push_back(temp_positions[static_cast<std::size_t>(key.pos_idx)]);
             }
-
-            // 삼각 팬으로 CCW winding을 유지한다.
-            for (std::size_t i = 0; i < vertexCount - 2; ++i)
+            for (const auto triangle : triangulator.Triangulate(facePositions) | std::views::chunk(3))
             {
-                meshToAddTo.indices.emplace_back(faceIndices[0]);
-                meshToAddTo.indices.emplace_back(faceIndices[i + 2]);
-                meshToAddTo.indices.emplace_back(faceIndices[i + 1]);
+                meshToAddTo.indices.emplace_back(faceIndices[triangle[0]]);
+                meshToAddTo.indices.emplace_back(faceIndices[triangle[2]]);
+                meshToAddTo.indices.emplace_back(faceIndices[triangle[1]]);
             }
         }
+
+        // 로더가 MessageBox를 직접 띄우던 UI 결합을 제거했다. 오류는
+        // expected로 Framework까지 전달되어 한 곳에서 사용자 메시지가 된다.
+        if (chunk.error)
+            return std::unexpected(malformed_obj(filename, lineOffsets[chunkIndex] + chunk.error->line, chunk.error->token));
     }
     
-    AABB modelAABB; // 모델 전체 AABB (모든 메시 통합용)
-
-    // 메시별 후처리(법선 생성, AABB 계산, 옥트리 빌드)를 병렬 처리
-    tbb::combinable<AABB> localAABB([] { return AABB(); }); // 스레드 로컬 AABB
+    if (!outModel->m_meshes.empty())
+        closeMesh(outModel->m_meshes.back());
 
-    tbb::parallel_for(tbb::blocked_range<std::size_t>(0, outModel->m_meshes.size()),
-        [&](const tbb::blocked_range<std::size_t>& r) {
-        for (std::size_t i = r.begin(); i != r.end(); ++i)
-        {
-            auto& mesh = outModel->m_meshes[i];
+    // 메시 목록이 확정되었다. 모델이 공개되기 전에 준비 플래그를 만들어 둔다.
+    outModel->prepareReadiness();
 
-            // OBJ의 모든 정점에 유효한 vn이 있는지 확인한다.
-            // 하나라도 빠졌다면 일관된 조명을 위해 전체 메시 법선을 생성한다.
-            const bool hasNormals = std::ranges::all_of(mesh.vertices, [](const Vertex& vertex) {
-                return SRMath::dot(vertex.normal, vertex.normal) > 1e-12f;
-                });
+    // 매핑은 RAII로 해제된다. 모델은 매핑된 텍스트를 참조하지 않는다.
+    return outModel;
+}
 
-            // If there is no Normal vector in OBJ File
-            if (!hasNormals)
-            {
-                // 각 정점의 법선을 0으로 초기화
-                for (auto& vertex : mesh.vertices)
-                {
-                    vertex.normal = SRMath::vec3(0.0f, 0.0f, 0.0f);
-                }
+bool ModelLoader::finalizeModel(Model& model, std::stop_token stop, const AccelerationSettings& acceleration,
+    ModelLoadProfile* profile)
+{
+    // 렌더 스레드는 준비 플래그가 선 메시만 읽으므로 나머지 메시를 계속 채워도 안전하다.
+    tbb::parallel_for(std::size_t{ 0 }, model.m_meshes.size(), [&model, &stop, &acceleration, profile](std::size_t i) {
+        if (stop.stop_requested()) return;
+        finalize_mesh(model.m_meshes[i], acceleration, profile);
+        model.markMeshReady(i);
+    });
+    if (stop.stop_requested()) return false;
 
-                // 인덱스는 세 개가 한 삼각형이라는 구조를 chunk view로 직접
-                // 표현한다. C++11식 i += 3과 idx+n 수동 계산을 제거한다.
-                for (const auto triangle : mesh.indices | std::views::chunk(3))
-                {
-                    const unsigned int i0 = triangle[0];
-                    const unsigned int i1 = triangle[1];
-                    const unsigned int i2 = triangle[2];
+    // 메시 AABB는 이미 계산되었으므로 모델 AABB는 순차 병합으로 충분하다.
+    AABB modelAABB;
+    for (const Mesh& mesh : model.m_meshes)
+        modelAABB.Encapsulate(mesh.localAABB);
+    model.m_localAABB = modelAABB;
+    model.markComplete();
+    return true;
+}
 
-                    const SRMath::vec3& v0 = mesh.vertices[i0].position;
-                    const SRMath::vec3& v1 = mesh.vertices[i1].position;
-                    const SRMath::vec3& v2 = mesh.vertices[i2].position;
+std::expected<std::unique_ptr<Model>, AssetLoadError> ModelLoader::LoadOBJ(const std::filesystem::path& inputPath,
+    const ModelLoadOptions& options)
+{
+    const auto filename = resolve_obj_path(inputPath);
 
-                    // 렌더링 인덱스는 화면 컬링을 위해 winding을 반전해 저장된다.
-                    // 자동 법선은 원본 OBJ의 바깥쪽을 향하도록 교차곱 순서를 반대로 사용한다.
-                    SRMath::vec3 face_normal = SRMath::cross(v2 - v0, v1 - v0);
+    // 원본과 MTL이 바뀌지 않았으면 파싱/법선/AABB/가속 구조 빌드를 모두 건너뛰고
+    // 캐시 파일을 매핑해 그대로 쓴다.
+    if (options.useCache)
+    {
+        if (auto cachedModel = MeshCache::TryLoad(filename, options.acceleration))
+            return cachedModel;
+    }
 
-                    // 0벡터 방지 후 정규화
-                    float length = SRMath::length(face_normal);
-                    if (length > 1e-6f) // 0벡터 방지
-                    {
-                        face_normal = SRMath::normalize(face_normal);
-                    }
-                    else
-                    {
-                        face_normal = SRMath::vec3(0.0f, 0.0f, 0.0f);
-                    }
+    std::vector<CacheDependency> cacheDependencies;
+    auto model = parseOBJ(filename, options.profile, options.useCache ? &cacheDependencies : nullptr);
+    if (!model)
+        return std::unexpected(std::move(model.error()));
+    finalizeModel(**model, {}, options.acceleration, options.profile);
 
-                    // 정점 법선에 면 법선 누적 (스무딩)
-                    mesh.vertices[i0].normal = mesh.vertices[i0].normal + face_normal;
-                    mesh.vertices[i1].normal = mesh.vertices[i1].normal + face_normal;
-                    mesh.vertices[i2].normal = mesh.vertices[i2].normal + face_normal;
-                }
+    // 캐시 쓰기 실패(읽기 전용 디렉터리 등)는 로드 결과에 영향을 주지 않는다.
+    if (options.useCache)
+        MeshCache::Write(filename, **model, cacheDependencies, options.acceleration);
+    return model;
+}
 
-                // 각 정점의 법선을 정규화하여 부드러운 법선(Smooth Normal) 생성
-                for (auto& vertex : mesh.vertices)
-                {
-                    float length = SRMath::length(vertex.normal);
-                    if (length > 1e-6f)
-                        vertex.normal = SRMath::normalize(vertex.normal);
-                    else
-                        vertex.normal = SRMath::vec3(0.0f, 1.0f, 0.0f); // 기본 위쪽 방향
-                }
-            }
+std::shared_ptr<ModelLoadHandle> ModelLoader::LoadOBJAsync(const std::filesystem::path& inputPath,
+    const AccelerationSettings& acceleration)
+{
+    auto handle = std::make_shared<ModelLoadHandle>(resolve_obj_path(inputPath), acceleration);
+    // 스레드는 핸들의 마지막 멤버로 소유되어 핸들 소멸 시 중단 요청 후 join된다.
+    // 따라서 작업 함수가 핸들을 참조로 잡아도 수명이 안전하다.
+    ModelLoadHandle& target = *handle;
+    handle->m_worker = std::jthread([&target](std::stop_token stop) {
+        loadAsync(target, std::move(stop));
+    });
+    return handle;
+}
 
-            // 메시 AABB 계산 및 모델 전체 통합
-            AABB meshAABB = AABB::CreateFromMesh(mesh);
-            mesh.localAABB = meshAABB;
+std::shared_ptr<ModelLoadHandle> ModelLoader::AcquireOBJAsync(const std::filesystem::path& filepath,
+    const AccelerationSettings& acceleration)
+{
+    return model_handle_cache().FindOrStart(resolve_obj_path(filepath), acceleration, [&filepath, &acceleration] {
+        return LoadOBJAsync(filepath, acceleration);
+    });
+}
 
-			localAABB.local().Encapsulate(meshAABB); // 스레드 로컬 AABB에 통합
+void ModelLoader::loadAsync(ModelLoadHandle& handle, std::stop_token stop)
+{
+    const std::filesystem::path& filename = handle.m_path;
+    const AccelerationSettings& acceleration = handle.m_acceleration;
+    if (std::shared_ptr<Model> cachedModel = MeshCache::TryLoad(filename, acceleration))
+    {
+        handle.m_model.store(std::move(cachedModel), std::memory_order_release);
+        handle.m_state.store(EModelLoadState::Ready, std::memory_order_release);
+        return;
+    }
 
-            // Octree 생성 및 빌드 (가시화/프러스텀 컬링 최적화)
-            mesh.octree = std::make_unique<Octree>();
-            mesh.octree->Build(mesh);
-		}});
+    std::vector<CacheDependency> cacheDependencies;
+    auto parsed = parseOBJ(filename, nullptr, &cacheDependencies);
+    if (!parsed)
+    {
+        handle.m_error = std::move(parsed.error());
+        handle.m_state.store(EModelLoadState::Failed, std::memory_order_release);
+        return;
+    }
 
-    // 최종적으로 thread-local AABB들을 병합
-    localAABB.combine_each([&](const AABB& aabb) {
-        modelAABB.Encapsulate(aabb);
-        });
-    // 최종 계산된 AABB 모델에 저장
-    
-    outModel->m_localAABB = modelAABB;
+    // 조립된 메시 표를 먼저 공개하고 후처리가 끝나는 메시부터 그려지게 한다.
+    // 첫 프레임까지의 시간이 가장 큰 메시의 옥트리 빌드가 아닌 파싱 시간에 묶인다.
+    const std::shared_ptr<Model> model = std::move(*parsed);
+    handle.m_model.store(model, std::memory_order_release);
+    if (!finalizeModel(*model, stop, acceleration, nullptr))
+        return;
 
-    // ifstream은 RAII로 닫힌다. C++11식 명시적 close는 조기 반환 경로를
-    // 놓치기 쉬워 제거했다.
-    return outModel; // 완성된 모델 반환
+    // 메시는 이미 모두 그려지고 있다. 캐시를 쓴 뒤에 Ready를 알려, 상태를 본 호출자가
+    // 핸들을 놓을 때 join이 캐시 쓰기를 기다리며 렌더 스레드를 막지 않게 한다.
+    MeshCache::Write(filename, *model, cacheDependencies, acceleration);
+    handle.m_state.store(EModelLoadState::Ready, std::memory_order_release);
 }
@@ -2,12 +2,36 @@
 #include <expected>
 #include <filesystem>
 #include <memory>
+#include <stop_token>
+#include <vector>
+#include "Graphics/ModelLoadOptions.h"
 #include "Utils/AssetLoadError.h"
 
 class Model;
+class ModelLoadHandle;
+struct CacheDependency;
 
 class ModelLoader
 {
+private:
+	// cacheDependencies가 있으면 OBJ와 MTL을 읽기 직전에 MeshCache::Stamp로 찍어 쌓는다.
+	[[nodiscard]] static std::expected<std::unique_ptr<Model>, AssetLoadError> parseOBJ(const std::filesystem::path& filename,
+		ModelLoadProfile* profile, std::vector<CacheDependency>* cacheDependencies);
+	// 메시별 후처리를 병렬로 실행하고 끝난 메시부터 준비 상태로 표시한다.
+	// 중단 요청을 받으면 남은 메시를 건너뛰고 false를 돌려준다.
+	static bool finalizeModel(Model& model, std::stop_token stop, const AccelerationSettings& acceleration,
+		ModelLoadProfile* profile);
+	static void loadAsync(ModelLoadHandle& handle, std::stop_token stop);
+
 public:
-	[[nodiscard]] static std::expected<std::unique_ptr<Model>, AssetLoadError> LoadOBJ(const std::filesystem::path& filepath);
+	[[nodiscard]] static std::expected<std::unique_ptr<Model>, AssetLoadError> LoadOBJ(const std::filesystem::path& filepath,
+		const ModelLoadOptions& options = {});
+	// 즉시 핸들을 돌려주고 백그라운드 스레드에서 로드한다. 메시 표가 조립되면
+	// 핸들에 모델이 나타나고, 각 메시는 후처리가 끝나는 대로 준비 상태가 된다.
+	[[nodiscard]] static std::shared_ptr<ModelLoadHandle> LoadOBJAsync(const std::filesystem::path& filepath,
+		const AccelerationSettings& acceleration = {});
+	// 같은 파일의 로드가 진행 중이거나 그 모델이 살아 있으면 그 핸들을 돌려준다.
+	// 인스턴스는 정점/인덱스/옥트리/재질을 공유하고 변환만 따로 가진다.
+	[[nodiscard]] static std::shared_ptr<ModelLoadHandle> AcquireOBJAsync(const std::filesystem::path& filepath,
+		const AccelerationSettings& acceleration = {});
 };
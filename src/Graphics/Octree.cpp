@@ -1,188 +1,388 @@
 ﻿#include "Octree.h"
-#include <vector>
+#include <algorithm>
 #include <array>
+#include <cstdint>
+#include <vector>
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_reduce.h>
 #include "Math/SRMath.h"
 #include "Graphics/Mesh.h"
 #include "Math/AABB.h"
-#include "Renderer/RenderQueue.h"
-#include "Math/Frustum.h"
-#include "Utils/DebugUtils.h"
 
-class Octree::OctreeNode {
+// 빌드 중에만 존재하는 노드. 자식 빌드를 병렬로 돌리기 쉽도록 포인터 트리로 만들고
+// Build 끝에서 AccelerationStructure::Node 배열로 평탄화한 뒤 통째로 해제한다.
+class Octree::BuildNode {
 public:
-	AABB bounds;
-	// 자식 수는 옥트리 정의상 항상 8개이므로 동적 컨테이너가 아닌 array가 맞다.
-	std::array<std::unique_ptr<OctreeNode>, 8> children{};
-	std::vector<unsigned int> triangleIndices;
-
-	explicit OctreeNode(const AABB& bounds) : bounds(bounds) {}
+	AABB bounds;		// 루트 셀. 삼각형이 없는 루트(빈 메시)의 노드 경계로만 쓴다
+	AABB fittedBounds;	// 하위 트리 삼각형을 딱 맞게 감싸는 경계. 평탄화한 노드 경계가 된다
+	std::array<std::uint32_t, 3> cell{};	// 자기 깊이에서의 셀 좌표 (x, y, z)
+	// 정렬된 삼각형 배열 안의 구간. [begin, stayEnd)는 이 노드에 남은 삼각형,
+	// [stayEnd, end)는 모턴 순으로 자식 구간들이 이어진다.
+	std::size_t begin = 0;
+	std::size_t stayEnd = 0;
+	std::size_t end = 0;
+	// 옥탄트 인덱스 비트 의미: (i & 1) → X(+), (i & 2) → Y(+), (i & 4) → Z(+).
+	// 삼각형이 하나도 없는 옥탄트는 만들지 않는다.
+	std::array<std::unique_ptr<BuildNode>, 8> children{};
 };
 
-// 옥트리 생성/소멸자 (기본 구현)
-Octree::Octree() = default;
-Octree::~Octree() = default;
-
-// 리프 노드가 과도한 삼각형을 가질 때 8개 옥탄트로 분할하는 함수
-void Octree::subdivide(OctreeNode* node)
+namespace
 {
-	// 현재 노드 AABB의 중심점과 절반 크기
-	SRMath::vec3 center = (node->bounds.min + node->bounds.max) * 0.5f;
-	SRMath::vec3 half_size = (node->bounds.max - node->bounds.min) * 0.5f;
-
-	// 1. 8개의 자식 노드를 생성하고 경계를 설정합니다.
-	//    인덱스 비트 의미: (i & 1) → X(+), (i & 2) → Y(+), (i & 4) → Z(+)
-	for (std::size_t i = 0; i < node->children.size(); ++i)
+	// 10비트 값의 비트 사이에 0을 두 개씩 끼워 넣는다 (비트 i → 비트 3i).
+	[[nodiscard]] constexpr std::uint32_t expand_bits(std::uint32_t value) noexcept
 	{
-		AABB childBounds;
-		// min은 비트에 따라 center 또는 부모 min에서 시작
-		childBounds.min.x = (i & 1) ? center.x : node->bounds.min.x;
-		childBounds.min.y = (i & 2) ? center.y : node->bounds.min.y;
-		childBounds.min.z = (i & 4) ? center.z : node->bounds.min.z;
-		// max는 min + half_size로 설정 (축 정렬 유지)
-		childBounds.max = childBounds.min + half_size;
-		// 자식 노드 생성
-		node->children[i] = std::make_unique<OctreeNode>(childBounds);
+		std::uint32_t x = value & 0x3ffu;
+		x = (x | x << 16) & 0x030000ffu;
+		x = (x | x << 8) & 0x0300f00fu;
+		x = (x | x << 4) & 0x030c30c3u;
+		x = (x | x << 2) & 0x09249249u;
+		return x;
 	}
 
-	// 2. 기존 노드의 삼각형 목록을 임시로 옮겨둡니다. (이후 재배치)
-	std::vector<unsigned int> tempVertexIndices = std::move(node->triangleIndices);
-	node->triangleIndices.clear(); // 이제 부모 노드는 경계에 걸친 삼각형만 가질 것입니다.
-
-	// 3. 임시 목록의 모든 삼각형들을 다시 'insert'하여 올바른 위치(자신 또는 자식)에 재배치합니다.
-	for (size_t i = 0; i < tempVertexIndices.size(); i += 3)
+	// 상위 3비트씩 끊어 읽으면 루트부터의 옥탄트 경로가 되는 30비트 모턴 코드.
+	// 한 묶음 안의 비트 배치가 옥탄트 인덱스(X=1, Y=2, Z=4)와 같다.
+	[[nodiscard]] constexpr std::uint32_t morton_code(std::uint32_t x, std::uint32_t y, std::uint32_t z) noexcept
 	{
-		unsigned int i0 = tempVertexIndices[i];
-		unsigned int i1 = tempVertexIndices[i + 1];
-		unsigned int i2 = tempVertexIndices[i + 2];
-		insert(node, i0, i1, i2); // 재귀 호출이 아닌, 현재 노드부터 다시 삽입 시작
+		return expand_bits(x) | (expand_bits(y) << 1) | (expand_bits(z) << 2);
 	}
-}
 
-// 삼각형(i0,i1,i2)을 현재 노드/자식 노드에 삽입
-void Octree::insert(OctreeNode* node, unsigned int i0, unsigned int i1, unsigned int i2)
-{
-	// 삼각형 정점의 로컬(메시) 공간 좌표
-	const auto& v0 = sourceMesh->vertices[i0].position;
-	const auto& v1 = sourceMesh->vertices[i1].position;
-	const auto& v2 = sourceMesh->vertices[i2].position;;
-
-	// 삼각형의 AABB 계산 (정확한 포함 판별용)
-	AABB triBounds;
-	triBounds.min = { std::min({v0.x, v1.x, v2.x}), std::min({v0.y, v1.y, v2.y}), std::min({v0.z, v1.z, v2.z}) };
-	triBounds.max = { std::max({v0.x, v1.x, v2.x}), std::max({v0.y, v1.y, v2.y}), std::max({v0.z, v1.z, v2.z}) };
-
-	// 현재 노드가 내부 노드(자식이 있음)일 경우
-	if (node->children.front())
+	// (코드, 삼각형 번호) 쌍을 코드 기준으로 안정 정렬하는 LSD 기수 정렬. 10비트씩 3번
+	// 나누며, 블록별 히스토그램과 분배를 병렬로 실행하고 모든 키가 같은 숫자인 자리는 건너뛴다.
+	void radix_sort(std::vector<std::uint32_t>& keys, std::vector<std::uint32_t>& values)
 	{
-		// 삼각형이 어떤 자식 노드 하나에 '완전히' 포함되는지 확인
-		for (std::size_t i = 0; i < node->children.size(); ++i)
+		constexpr unsigned int digit_bits = 10;
+		constexpr std::size_t digit_count = std::size_t{ 1 } << digit_bits;
+		constexpr std::size_t block_size = 16384;
+		const std::size_t count = keys.size();
+		const std::size_t blockCount = (count + block_size - 1) / block_size;
+		std::vector<std::uint32_t> keyScratch(count);
+		std::vector<std::uint32_t> valueScratch(count);
+		std::vector<std::array<std::size_t, digit_count>> offsets(blockCount);
+
+		for (unsigned int shift = 0; shift < 30; shift += digit_bits)
 		{
-			if (node->children[i]->bounds.Contains(triBounds))
+			tbb::parallel_for(std::size_t{ 0 }, blockCount, [&](std::size_t block) {
+				auto& histogram = offsets[block];
+				histogram.fill(0);
+				const std::size_t end = std::min(count, (block + 1) * block_size);
+				for (std::size_t i = block * block_size; i != end; ++i) ++histogram[(keys[i] >> shift) & (digit_count - 1)];
+			});
+
+			// 숫자 순, 같은 숫자 안에서는 블록 순으로 시작 위치를 매겨야 정렬이 안정하다.
+			std::size_t running = 0;
+			bool singleDigit = false;
+			for (std::size_t digit = 0; digit < digit_count; ++digit)
 			{
-				// 완전히 포함되면 해당 자식으로 삽입 (더 아래로 내려감)
-				insert(node->children[i].get(), i0, i1, i2);
-				return; // 자식에게 삽입했으므로 현재 노드에서의 역할은 끝남
+				const std::size_t digitBegin = running;
+				for (auto& histogram : offsets)
+				{
+					const std::size_t digitTotal = histogram[digit];
+					histogram[digit] = running;
+					running += digitTotal;
+				}
+				if (running - digitBegin == count) singleDigit = true;
 			}
+			if (singleDigit) continue;
+
+			tbb::parallel_for(std::size_t{ 0 }, blockCount, [&](std::size_t block) {
+				auto& next = offsets[block];
+				const std::size_t end = std::min(count, (block + 1) * block_size);
+				for (std::size_t i = block * block_size; i != end; ++i)
+				{
+					const std::size_t destination = next[(keys[i] >> shift) & (digit_count - 1)]++;
+					keyScratch[destination] = keys[i];
+					valueScratch[destination] = values[i];
+				}
+			});
+			keys.swap(keyScratch);
+			values.swap(valueScratch);
 		}
 	}
+}
 
-	// 다음 두 가지 경우에 삼각형을 현재 노드에 추가합니다:
-	// 1. 현재 노드가 리프 노드일 경우
-	// 2. 현재 노드는 내부 노드지만, 삼각형이 경계에 걸쳐 있어 자식에게 줄 수 없는 경우
-	node->triangleIndices.push_back(i0);
-	node->triangleIndices.push_back(i1);
-	node->triangleIndices.push_back(i2);
-
-	// 리프 노드가 너무 많은 삼각형을 가지면 분할 (분할 후 재배치는 subdivide 함수가 담당)
-	if (!node->children.front() && (node->triangleIndices.size() / 3) > max_triangles_per_node)
-	{
-		subdivide(node);
-	}
+Octree::Octree(const Mesh& mesh, std::size_t maxLeafTriangles, float looseness)
+	: m_mesh(mesh),
+	  m_maxLeafTriangles(maxLeafTriangles),
+	  m_looseness(std::max(looseness, 1.f))
+{
 }
 
-// 메시를 바탕으로 옥트리를 빌드(루트 생성 → 모든 삼각형 삽입)
-void Octree::Build(const Mesh& mesh)
+Octree::~Octree() = default;
+
+// 삼각형 t의 로컬(메시) 공간 AABB
+AABB Octree::triangleBoundsAt(std::size_t t) const
 {
-	this->sourceMesh = &mesh;                 // 삼각형 정점 참조용 원본 메시 포인터 보관
+	const auto vertices = m_mesh.GetVertices();
+	const auto indices = m_mesh.GetIndices();
+	const auto& v0 = vertices[indices[t * 3]].position;
+	const auto& v1 = vertices[indices[t * 3 + 1]].position;
+	const auto& v2 = vertices[indices[t * 3 + 2]].position;
 
-	AABB rootBounds = AABB::CreateFromMesh(mesh); // 메시 전체를 감싸는 AABB
+	AABB triBounds;
+	triBounds.min = { std::min({v0.x, v1.x, v2.x}), std::min({v0.y, v1.y, v2.y}), std::min({v0.z, v1.z, v2.z}) };
+	triBounds.max = { std::max({v0.x, v1.x, v2.x}), std::max({v0.y, v1.y, v2.y}), std::max({v0.z, v1.z, v2.z}) };
+	return triBounds;
+}
 
-	root = std::make_unique<OctreeNode>(rootBounds); // 루트 노드 생성
+// 깊이 depth에서 좌표 cell인 셀의 경계
+AABB Octree::cellBounds(std::size_t depth, const std::array<std::uint32_t, 3>& cell) const
+{
+	const SRMath::vec3 size = m_rootSize * (1.f / static_cast<float>(std::uint32_t{ 1 } << depth));
+	AABB bounds;
+	bounds.min = {
+		m_rootMin.x + size.x * static_cast<float>(cell[0]),
+		m_rootMin.y + size.y * static_cast<float>(cell[1]),
+		m_rootMin.z + size.z * static_cast<float>(cell[2]) };
+	bounds.max = bounds.min + size;
+	return bounds;
+}
 
-	// 메시의 모든 삼각형을 루트로부터 삽입
-	for (size_t i = 0; i < mesh.indices.size(); i += 3)
-	{
-		insert(root.get(), mesh.indices[i], mesh.indices[i + 1], mesh.indices[i + 2]);
-	}
+// 정렬된 배열의 [begin, end) 구간 삼각형들을 딱 맞게 감싸는 경계
+AABB Octree::fitRange(std::size_t begin, std::size_t end) const
+{
+	const auto fit = [this](std::size_t first, std::size_t last, AABB bounds) {
+		for (std::size_t p = first; p != last; ++p) bounds.Encapsulate(m_triangleBounds[p]);
+		return bounds;
+	};
+
+	if (end - begin < parallel_build_triangles) return fit(begin, end, AABB{});
+	return tbb::parallel_reduce(tbb::blocked_range<std::size_t>(begin, end, parallel_build_triangles / 4), AABB{},
+		[&fit](const tbb::blocked_range<std::size_t>& range, AABB bounds) { return fit(range.begin(), range.end(), bounds); },
+		[](AABB lhs, const AABB& rhs) { lhs.Encapsulate(rhs); return lhs; });
 }
 
-// 재귀적으로 프러스텀 컬링 및 렌더 큐 제출(디버그 AABB 포함)
-void Octree::submitNodeRecursive(RenderQueue& renderQueue, const Frustum& frustum, const SRMath::mat4& worldTransform,
-	std::vector<MeshRenderCommand>& threadLocalCmd, std::vector<DebugPrimitiveCommand>& threadlocalDebugCmd,
-	const DebugFlags& debugFlags, const OctreeNode* node)
+// 노드 구간에서 중심이 속한 자식의 느슨한 경계에 다 들어가지 않는 삼각형을 골라
+// 구간 앞으로 모으고 node.stayEnd와 그 삼각형들의 경계를 채운다. 자식으로 내려가는
+// 삼각형들의 상대 순서는 그대로라서 자식 구간이 모턴 순으로 이어진 상태가 유지된다.
+void Octree::partitionStaying(BuildNode& node, std::size_t depth)
 {
-	// 노드 경계를 월드 공간으로 변환
-	const AABB worldNodeAABB = node->bounds.Transform(worldTransform);
-	// 프러스텀 밖이면 조기 리턴 (컬링)
-	if(!frustum.IsAABBInFrustum(worldNodeAABB)) return; // 절두체 밖에 있으면 컬링
+	const unsigned int shift = 3 * (morton_bits - 1 - static_cast<unsigned int>(depth));
+
+	// 자식 8개의 느슨한 경계: 셀 중심은 그대로 두고 크기만 looseness배 (1이면 셀과 정확히 같다)
+	std::array<AABB, 8> looseBounds;
+	for (std::uint32_t octant = 0; octant < looseBounds.size(); ++octant)
+	{
+		const AABB cell = cellBounds(depth + 1, {
+			node.cell[0] * 2 + (octant & 1),
+			node.cell[1] * 2 + ((octant >> 1) & 1),
+			node.cell[2] * 2 + ((octant >> 2) & 1) });
+		const SRMath::vec3 margin = (cell.max - cell.min) * (0.5f * (m_looseness - 1.f));
+		looseBounds[octant].min = cell.min - margin;
+		looseBounds[octant].max = cell.max + margin;
+	}
 
-	// 이 노드에 삼각형이 있으면 렌더 큐에 메시 렌더 명령 제출
-	if(!node->triangleIndices.empty())
+	// 남는 삼각형 수와 경계를 분류하면서 같이 모은다.
+	struct Tally
 	{
-		MeshRenderCommand cmd;
-		cmd.sourceMesh = this->sourceMesh;                 // 원본 메시
-		cmd.indicesToDraw = node->triangleIndices;         // 이 노드에 속한 삼각형 인덱스 서브셋
-		cmd.worldTransform = worldTransform;               // 오브젝트의 월드 변환
-		cmd.material = &this->sourceMesh->material;        // 메시의 재질을 사용
-
-		// 와이어/필 모드 전환 (디버그 플래그에 따름)
-		if(debugFlags.bShowWireframe)
+		std::size_t count = 0;
+		AABB bounds;
+	};
+	const auto classify = [&](std::size_t first, std::size_t last, Tally tally) {
+		for (std::size_t p = first; p != last; ++p)
 		{
-			cmd.rasterizeMode = ERasterizeMode::Wireframe;
+			const auto octant = static_cast<std::size_t>((m_codes[p] >> shift) & 7);
+			const bool stay = !looseBounds[octant].Contains(m_triangleBounds[p]);
+			m_stays[p] = static_cast<std::uint8_t>(stay);
+			if (!stay) continue;
+			++tally.count;
+			tally.bounds.Encapsulate(m_triangleBounds[p]);
 		}
-		else
+		return tally;
+	};
+
+	const Tally staying = node.end - node.begin < parallel_build_triangles
+		? classify(node.begin, node.end, Tally{})
+		: tbb::parallel_reduce(tbb::blocked_range<std::size_t>(node.begin, node.end, parallel_build_triangles / 4), Tally{},
+			[&classify](const tbb::blocked_range<std::size_t>& range, Tally tally) { return classify(range.begin(), range.end(), tally); },
+			[](Tally lhs, const Tally& rhs) { lhs.count += rhs.count; lhs.bounds.Encapsulate(rhs.bounds); return lhs; });
+	node.stayEnd = node.begin + staying.count;
+	node.fittedBounds = staying.bounds;
+	if (staying.count == 0) return;
+
+	// 남는 삼각형은 제자리에서 앞으로 당기고(쓰는 위치가 읽는 위치를 앞서지 않는다)
+	// 내려가는 삼각형만 임시로 옮겼다가 그 뒤에 붙인다.
+	std::vector<std::uint32_t> codes;
+	std::vector<std::uint32_t> triangles;
+	std::vector<AABB> bounds;
+	const std::size_t descending = node.end - node.stayEnd;
+	codes.reserve(descending);
+	triangles.reserve(descending);
+	bounds.reserve(descending);
+	std::size_t stay = node.begin;
+	for (std::size_t p = node.begin; p != node.end; ++p)
+	{
+		if (m_stays[p] != 0)
 		{
-			cmd.rasterizeMode = ERasterizeMode::Fill;
+			m_codes[stay] = m_codes[p];
+			m_triangles[stay] = m_triangles[p];
+			m_triangleBounds[stay] = m_triangleBounds[p];
+			++stay;
+			continue;
 		}
+		codes.push_back(m_codes[p]);
+		triangles.push_back(m_triangles[p]);
+		bounds.push_back(m_triangleBounds[p]);
+	}
+	std::ranges::copy(codes, m_codes.begin() + node.stayEnd);
+	std::ranges::copy(triangles, m_triangles.begin() + node.stayEnd);
+	std::ranges::copy(bounds, m_triangleBounds.begin() + node.stayEnd);
+}
 
-		threadLocalCmd.push_back(cmd); // 멀티스레드 로컬 렌더 명령 큐에 추가
+// 노드 구간을 위에서 아래로 나눈다. 리프가 m_maxLeafTriangles를 넘으면 8분할하고,
+// 삼각형은 중심이 속한 옥탄트 자식으로 보내되 그 자식의 느슨한 경계에 다 들어가지
+// 않으면 이 노드에 남긴다. looseness가 1이면 고전 옥트리이고, 2면 자식 셀 크기의
+// 절반 이하인 삼각형은 모두 내려가 경계에 걸친 삼각형이 부모에 쌓이지 않는다.
+// 옥탄트는 모턴 코드의 다음 3비트이므로 자식 구간은 정렬된 구간을 자르기만 하면 된다.
+void Octree::buildNode(BuildNode* node, std::size_t depth)
+{
+	const std::size_t triangleCount = node->end - node->begin;
+	if (triangleCount <= m_maxLeafTriangles || depth >= max_depth)
+	{
+		node->stayEnd = node->end;
+		node->fittedBounds = fitRange(node->begin, node->end);
+		return;
 	}
+	partitionStaying(*node, depth);
 
-	// 디버그: 노드 AABB를 선분으로 렌더 큐에 제출
-	if (debugFlags.bShowAABB)
+	const unsigned int shift = 3 * (morton_bits - 1 - static_cast<unsigned int>(depth));
+	std::size_t childBegin = node->stayEnd;
+	for (std::uint32_t octant = 0; octant < node->children.size() && childBegin != node->end; ++octant)
 	{
-		// AABB 8개 꼭짓점 계산
-		const auto vertices = worldNodeAABB.Corners();
-		SRMath::vec4 color = SRMath::vec4(1.0f, 0.0f, 0.0f, 1.0f); // 빨간색
-		std::vector<DebugVertex> debugVertices;
-
-		// 12개의 엣지를 선분으로 추가 (Bottom/Top/Sides)
-		debugVertices.insert(debugVertices.end(), {
-			{vertices[0], color}, {vertices[1], color}, {vertices[1], color}, {vertices[3], color}, {vertices[3], color}, {vertices[2], color}, {vertices[2], color}, {vertices[0], color}, // Bottom
-			{vertices[4], color}, {vertices[5], color}, {vertices[5], color}, {vertices[7], color}, {vertices[7], color}, {vertices[6], color}, {vertices[6], color}, {vertices[4], color}, // Top
-			{vertices[0], color}, {vertices[4], color}, {vertices[1], color}, {vertices[5], color}, {vertices[2], color}, {vertices[6], color}, {vertices[3], color}, {vertices[7], color}  // Sides
-			});
+		const auto childEnd = static_cast<std::size_t>(std::partition_point(
+			m_codes.begin() + childBegin, m_codes.begin() + node->end,
+			[shift, octant](std::uint32_t code) { return ((code >> shift) & 7) <= octant; }) - m_codes.begin());
+		if (childEnd == childBegin) continue;
 
-		// 디버그 프리미티브(선분) 제출
-		DebugPrimitiveCommand cmd;
-		cmd.vertices = debugVertices;
-		cmd.worldTransform = SRMath::mat4::identity(); // 이미 월드로 변환된 좌표이므로 단위행렬
-		cmd.type = DebugPrimitiveType::Line;
-		threadlocalDebugCmd.push_back(cmd);
+		auto child = std::make_unique<BuildNode>();
+		child->cell = {
+			node->cell[0] * 2 + (octant & 1),
+			node->cell[1] * 2 + ((octant >> 1) & 1),
+			node->cell[2] * 2 + ((octant >> 2) & 1) };
+		child->begin = childBegin;
+		child->end = childEnd;
+		node->children[octant] = std::move(child);
+		childBegin = childEnd;
+	}
+
+	// 자식 구간은 서로 겹치지 않으므로 큰 노드에서는 동시에 빌드한다.
+	const auto buildChild = [this, node, depth](std::size_t i) {
+		if (node->children[i]) buildNode(node->children[i].get(), depth + 1);
+	};
+	if (triangleCount >= parallel_build_triangles)
+	{
+		tbb::parallel_for(std::size_t{ 0 }, node->children.size(), buildChild);
+	}
+	else
+	{
+		for (std::size_t i = 0; i < node->children.size(); ++i) buildChild(i);
 	}
 
-	// 자식 노드들에 대해 동일 처리 (존재하는 경우에만)
-	for(const auto & child : node->children)
+	// 노드 경계는 셀이 아니라 실제 삼각형에 맞춘다. 느슨한 자식이 셀 밖으로 나가도
+	// 부모 경계가 자식을 감싸고, 빈 구석이 많은 셀도 삼각형 쪽으로 줄어든다.
+	for (const auto& child : node->children)
 	{
-		if (child) submitNodeRecursive(renderQueue, frustum, worldTransform, threadLocalCmd, threadlocalDebugCmd, debugFlags, child.get());
+		if (child) node->fittedBounds.Encapsulate(child->fittedBounds);
 	}
 }
 
-// 루트부터 시작하여 보이는 노드들을 렌더 큐에 제출하는 진입점
-void Octree::SubmitNodesToRenderQueue(RenderQueue& renderQueue, const Frustum& frustum, const SRMath::mat4& worldTransform,
-	std::vector<MeshRenderCommand>& threadLocalCmd, std::vector<DebugPrimitiveCommand>& threadlocalDebugCmd, const DebugFlags& debugFlags)
+// 메시를 바탕으로 옥트리를 빌드(삼각형 경계와 모턴 코드 → 기수 정렬 → 구간 분할 → 평탄화)
+AccelerationStructure::BuildResult Octree::Build()
 {
-	if (!root) return; // 빌드되지 않은 경우 무시
+	const std::size_t triangleCount = m_mesh.GetIndices().size() / 3;
+
+	BuildNode root;
+	root.bounds = AABB::CreateFromMesh(m_mesh); // 메시 전체를 감싸는 루트
+	root.end = triangleCount;
+	m_rootMin = root.bounds.min;
+	m_rootSize = root.bounds.max - root.bounds.min;
+
+	// 삼각형 중심을 루트 셀 안에서 축마다 10비트로 양자화한다. 폭이 0인 축은 모두 0번 칸이다.
+	constexpr float cell_count = static_cast<float>(std::uint32_t{ 1 } << morton_bits);
+	const auto axisScale = [](float size) { return size > 0.f ? cell_count / size : 0.f; };
+	const SRMath::vec3 scale{ axisScale(m_rootSize.x), axisScale(m_rootSize.y), axisScale(m_rootSize.z) };
+	const auto quantize = [](float cell) {
+		return static_cast<std::uint32_t>(std::clamp(cell, 0.f, cell_count - 1.f));
+	};
+
+	std::vector<AABB> triangleBounds(triangleCount);
+	m_codes.resize(triangleCount);
+	m_triangles.resize(triangleCount);
+	m_stays.resize(triangleCount);
+	tbb::parallel_for(tbb::blocked_range<std::size_t>(0, triangleCount, 1024),
+		[&](const tbb::blocked_range<std::size_t>& range) {
+			for (std::size_t t = range.begin(); t != range.end(); ++t)
+			{
+				const AABB box = triangleBoundsAt(t);
+				triangleBounds[t] = box;
+				const SRMath::vec3 offset = (box.min + box.max) * 0.5f - m_rootMin;
+				m_codes[t] = morton_code(quantize(offset.x * scale.x), quantize(offset.y * scale.y), quantize(offset.z * scale.z));
+				m_triangles[t] = static_cast<std::uint32_t>(t);
+			}
+		});
+	radix_sort(m_codes, m_triangles);
+
+	// 레벨마다 구간을 차례로 훑으므로 경계도 정렬 순서로 한 번 옮겨 둔다.
+	// 정점에서 다시 구하면 모턴 순서로 정점을 흩어 읽게 된다.
+	m_triangleBounds.resize(triangleCount);
+	tbb::parallel_for(tbb::blocked_range<std::size_t>(0, triangleCount, 1024),
+		[&](const tbb::blocked_range<std::size_t>& range) {
+			for (std::size_t p = range.begin(); p != range.end(); ++p) m_triangleBounds[p] = triangleBounds[m_triangles[p]];
+		});
+	triangleBounds = {};
+
+	buildNode(&root, 0);
+	return flatten(root);
+}
+
+// 빌드 트리를 너비 우선으로 펼친다. 순회는 포인터 대신 배열 인덱스를 따른다.
+// 인덱스 버퍼는 m_triangles 순서 그대로라서 노드의 [begin, end)가 곧 하위 트리 구간이다.
+// 자기 삼각형이 앞에 있고 자식 구간이 뒤따르며, 노드 안의 삼각형은 모턴 순이라
+// 가까운 삼각형끼리 이웃한다.
+AccelerationStructure::BuildResult Octree::flatten(const BuildNode& root) const
+{
+	using Node = AccelerationStructure::Node;
+	const auto indices = m_mesh.GetIndices();
+	AccelerationStructure::BuildResult result;
+	result.nodeIndices.resize((root.end - root.begin) * 3);
+	tbb::parallel_for(tbb::blocked_range<std::size_t>(root.begin, root.end, 1024),
+		[&](const tbb::blocked_range<std::size_t>& range) {
+			for (std::size_t p = range.begin(); p != range.end(); ++p)
+			{
+				const std::size_t first = std::size_t{ m_triangles[p] } * 3;
+				std::copy_n(indices.begin() + static_cast<std::ptrdiff_t>(first), 3, result.nodeIndices.begin() + static_cast<std::ptrdiff_t>(p * 3));
+			}
+		});
+
+	const auto makeNode = [](const BuildNode& node) {
+		// 삼각형이 없는 루트(빈 메시)만 맞출 대상이 없어 셀 경계를 쓴다.
+		const AABB& bounds = node.end != node.begin ? node.fittedBounds : node.bounds;
+		return Node{
+			{ bounds.min.x, bounds.min.y, bounds.min.z },
+			{ bounds.max.x, bounds.max.y, bounds.max.z },
+			static_cast<std::uint32_t>(node.begin * 3),
+			static_cast<std::uint32_t>((node.stayEnd - node.begin) * 3),
+			static_cast<std::uint32_t>((node.end - node.begin) * 3),
+			0u, 0u };
+	};
+
+	std::vector<const BuildNode*> order{ &root };
+	result.nodes.push_back(makeNode(root));
+	for (std::size_t i = 0; i < order.size(); ++i)
+	{
+		const BuildNode& node = *order[i];
+		// push_back이 재할당할 수 있으므로 참조 대신 인덱스로 기록한다.
+		const auto firstChild = static_cast<std::uint32_t>(order.size());
+		for (const auto& child : node.children)
+		{
+			if (!child) continue;
+			order.push_back(child.get());
+			result.nodes.push_back(makeNode(*child));
+		}
+		result.nodes[i].childCount = static_cast<std::uint32_t>(order.size()) - firstChild;
+		result.nodes[i].firstChild = result.nodes[i].childCount != 0 ? firstChild : 0u;
+	}
 
-	submitNodeRecursive(renderQueue, frustum, worldTransform, threadLocalCmd, threadlocalDebugCmd, debugFlags, root.get());
+	result.nodes.shrink_to_fit();
+	return result;
 }
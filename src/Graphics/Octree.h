@@ -1,42 +1,64 @@
 ﻿#pragma once
+#include <array>
 #include <cstddef>
+#include <cstdint>
 #include <memory>
 #include <vector>
 #include "Math/SRMath.h"
-#include "Renderer/RenderCommand.h"
+#include "Math/AABB.h"
+#include "Graphics/AccelerationStructure.h"
 
-class RenderQueue;
 struct Mesh;
-class Frustum;
-struct DebugFlags;
 
+// 메시 AABB를 중점에서 8분할하는 AccelerationStructure 빌더. 자식 셀을 looseness배로
+// 키운 느슨한 옥트리로도 빌드할 수 있다. 삼각형은 중심이 속한 자식의 느슨한 경계에
+// 들어가지 않을 때만 부모 노드에 남고, 노드 경계는 하위 트리 삼각형에 맞춰 줄인다.
+//
+// 삼각형 중심의 30비트 모턴 코드를 한 번 기수 정렬해 두면 노드마다 같은 접두사를
+// 가진 연속 구간이 되고, 자식 구간은 다음 3비트로 정렬된 구간을 자르기만 하면 된다.
+// 레벨마다 자식별 목록을 새로 만들지 않고 깊이도 max_depth로 묶여 있어 빌드 시간이
+// 삼각형 수에 선형이다.
 class Octree
 {
 private:
-	friend class Renderer; // Renderer.h에서 OctreeNode를 사용하기 때문에 필요
-	class OctreeNode;
+	class BuildNode; // 빌드 중에만 쓰는 포인터 트리. 평탄화한 뒤 버린다.
 
-	void subdivide(OctreeNode* node);
-	void insert(OctreeNode* node, unsigned int i0, unsigned int i1, unsigned int i2);
+	const Mesh& m_mesh;
+	std::size_t m_maxLeafTriangles;
+	float m_looseness;
 
-	std::unique_ptr<OctreeNode> root;
-	const Mesh* sourceMesh = nullptr;
+	// 루트 셀. 깊이 d 셀의 크기는 m_rootSize / 2^d 이다.
+	SRMath::vec3 m_rootMin;
+	SRMath::vec3 m_rootSize;
 
-	void submitNodeRecursive(RenderQueue& renderQueue, const Frustum& frustum, const SRMath::mat4& worldTransform,
-		std::vector<MeshRenderCommand>& threadLocalCmd, std::vector<DebugPrimitiveCommand>& localDebugCmd,
-		const DebugFlags& debugFlags, const OctreeNode* node);
+	// 모턴 코드 순으로 정렬된 삼각형별 (코드, 삼각형 번호, 경계). 정렬 뒤에는 노드에 남는
+	// 삼각형을 구간 앞으로 모으는 제자리 분할만 일어나며 세 배열이 같이 움직인다.
+	std::vector<std::uint32_t> m_codes;
+	std::vector<std::uint32_t> m_triangles;
+	std::vector<AABB> m_triangleBounds;
+	std::vector<std::uint8_t> m_stays;	// 분할 중 구간 위치별 표시 (1이면 이 노드에 남음)
 
+	[[nodiscard]] AABB triangleBoundsAt(std::size_t t) const;
+	[[nodiscard]] AABB cellBounds(std::size_t depth, const std::array<std::uint32_t, 3>& cell) const;
+	[[nodiscard]] AABB fitRange(std::size_t begin, std::size_t end) const;
+	void partitionStaying(BuildNode& node, std::size_t depth);
+	void buildNode(BuildNode* node, std::size_t depth);
+	[[nodiscard]] AccelerationStructure::BuildResult flatten(const BuildNode& root) const;
 
-
-	// 매크로나 별도 정의가 필요한 static const 대신 C++17 inline constexpr를
-	// 사용한다. 타입과 값이 선언 위치에 함께 있어 ODR 문제도 없다.
-	static constexpr std::size_t max_triangles_per_node = 16;
+	// 축마다 10비트로 양자화한다. 모턴 코드 한 단계(3비트)가 옥트리 한 깊이이다.
+	// 메시 크기의 1/1024 셀이면 프러스텀 컬링에는 충분히 잘고, 코드가 32비트에 들어가
+	// 기수 정렬이 3번으로 끝난다.
+	static constexpr std::uint32_t morton_bits = 10;
+	// 이 깊이의 노드는 삼각형 수와 관계없이 리프가 된다. 같은 자리에 겹친 삼각형이 많으면
+	// 아무리 나눠도 한도 아래로 내려가지 않고, 모턴 코드도 이보다 깊은 셀을 구분하지 못한다.
+	static constexpr std::size_t max_depth = morton_bits;
+	// 이보다 많은 삼각형이 도달한 노드는 분류, 경계 계산, 자식 빌드를 병렬로 실행한다.
+	static constexpr std::size_t parallel_build_triangles = 4096;
 public:
-	Octree();
+	Octree(const Mesh& mesh, std::size_t maxLeafTriangles, float looseness);
 	~Octree();
+	Octree(const Octree&) = delete;
+	Octree& operator=(const Octree&) = delete;
 
-	void Build(const Mesh& mesh);
-	[[nodiscard]] const OctreeNode* GetRoot() const noexcept { return root.get(); }
-	void SubmitNodesToRenderQueue(RenderQueue& renderQueue, const Frustum& frustum, const SRMath::mat4& worldTransform,
-		std::vector<MeshRenderCommand>& threadLocalCmd, std::vector<DebugPrimitiveCommand>& localDebugCmd, const DebugFlags& debugFlags);
+	[[nodiscard]] AccelerationStructure::BuildResult Build();
 };
@@ -1,26 +1,447 @@
 ﻿#include "Texture.h"
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <immintrin.h>
+#include <limits>
+#include <utility>
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include "Math/SIMD.h"
+
+namespace
+{
+	constexpr float byte_to_unit = 1.0f / 255.0f;
+
+	// F16C 명령은 MSVC에서 /arch 없이도 intrinsic으로 생성된다. RGBA16F는
+	// f16c_available()이 참일 때만 선택되므로 이 두 함수는 지원 CPU에서만 실행된다.
+	// 64비트 정수 <-> XMM 변환(_mm_cvtsi64_si128)은 x64에만 있으므로 메모리를 거치는
+	// movq 로드/저장을 써서 Win32 구성에서도 컴파일되게 한다.
+	[[nodiscard]] SRMath::Color4 half4_to_float4(std::uint64_t packed) noexcept
+	{
+		const __m128i halves = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(&packed));
+		return SRMath::Color4{ _mm_cvtph_ps(halves) };
+	}
+
+	[[nodiscard]] std::uint64_t float4_to_half4(const SRMath::Color4& color) noexcept
+	{
+		const __m128i halves = _mm_cvtps_ph(color.m128, _MM_FROUND_TO_NEAREST_INT);
+		std::uint64_t packed = 0;
+		_mm_storel_epi64(reinterpret_cast<__m128i*>(&packed), halves);
+		return packed;
+	}
+
+	// cvttss는 0 방향으로 자르므로 음수 UV에서 한 texel 어긋난다. SSE4.1
+	// roundss로 내림한 뒤 변환해 반복/미러 주기가 0 근처에서도 끊기지 않게 한다.
+	[[nodiscard]] int floor_to_int(float value) noexcept
+	{
+		const __m128 scalar = _mm_set_ss(value);
+		return _mm_cvtss_si32(_mm_floor_ss(scalar, scalar));
+	}
+
+	[[nodiscard]] float repeat_unit(float value) noexcept
+	{
+		const __m128 scalar = _mm_set_ss(value);
+		return value - _mm_cvtss_f32(_mm_floor_ss(scalar, scalar));
+	}
+
+	// 주기 2인 삼각파: [0, 1]에서 증가, [1, 2]에서 감소한다.
+	[[nodiscard]] float mirror_unit(float value) noexcept
+	{
+		const float period = repeat_unit(value * 0.5f) * 2.0f;
+		return 1.0f - std::abs(1.0f - period);
+	}
+
+	// stbi_load(..., 4)의 R,G,B,A 바이트를 little-endian 정수 하나로 읽는다.
+	[[nodiscard]] std::uint32_t load_rgba8(const unsigned char* rgba) noexcept
+	{
+		std::uint32_t bytes = 0;
+		std::memcpy(&bytes, rgba, sizeof(bytes));
+		return bytes;
+	}
+
+	// 네 바이트를 SSE4.1 zero-extend 한 번으로 float lane에 올린다. 채널마다
+	// 스칼라 곱을 하던 RGBA8 경로와 달리 곱셈도 벡터 한 번으로 끝난다.
+	[[nodiscard]] SRMath::Color4 unpack_bytes(std::uint32_t bytes) noexcept
+	{
+		const __m128i widened = _mm_cvtepu8_epi32(_mm_cvtsi32_si128(static_cast<int>(bytes)));
+		return SRMath::Color4{ _mm_mul_ps(_mm_cvtepi32_ps(widened), _mm_set1_ps(byte_to_unit)) };
+	}
+
+	// ---- BC1 ----
+	// 블록 64비트 배치: [0,16) color0, [16,32) color1 (RGB565), [32,64) texel마다
+	// 2-bit 팔레트 인덱스(행 우선, texel 0이 최하위). color0 > color1이면 4색,
+	// 아니면 3색 + 투명 검정 모드다.
+
+	struct DecodedBC1Block
+	{
+		std::uint64_t key = 0;	// (캐시 id << 32) | 블록 인덱스, 0은 빈 슬롯
+		std::array<std::uint32_t, 16> texels{};
+	};
+
+	// 64 슬롯 x 72 B ≈ 4.5 KB로 스레드당 L1에 충분히 들어간다.
+	constexpr std::size_t bc1_cache_slots = 64;
+	std::atomic<std::uint32_t> next_block_cache_id{ 1 };
+
+	[[nodiscard]] constexpr std::uint32_t rgb_bytes(std::uint32_t r, std::uint32_t g, std::uint32_t b, std::uint32_t a) noexcept
+	{
+		return r | (g << 8) | (b << 16) | (a << 24);
+	}
+
+	// 565 채널을 비트 복제로 8비트까지 늘려 0과 최대값이 정확히 0/255가 되게 한다.
+	[[nodiscard]] constexpr std::uint32_t expand_565(std::uint16_t color) noexcept
+	{
+		const std::uint32_t r = (color >> 11) & 31u;
+		const std::uint32_t g = (color >> 5) & 63u;
+		const std::uint32_t b = color & 31u;
+		return rgb_bytes((r << 3) | (r >> 2), (g << 2) | (g >> 4), (b << 3) | (b >> 2), 255u);
+	}
+
+	[[nodiscard]] constexpr std::uint16_t quantize_565(int r, int g, int b) noexcept
+	{
+		return static_cast<std::uint16_t>(((r * 31 + 127) / 255) << 11 | ((g * 63 + 127) / 255) << 5 | ((b * 31 + 127) / 255));
+	}
+
+	[[nodiscard]] constexpr std::uint32_t channel(std::uint32_t rgba, int index) noexcept
+	{
+		return (rgba >> (index * 8)) & 0xFFu;
+	}
+
+	[[nodiscard]] constexpr std::uint32_t blend_rgb(std::uint32_t a, std::uint32_t b, std::uint32_t weightA, std::uint32_t weightB) noexcept
+	{
+		const std::uint32_t total = weightA + weightB;
+		return rgb_bytes((channel(a, 0) * weightA + channel(b, 0) * weightB) / total,
+			(channel(a, 1) * weightA + channel(b, 1) * weightB) / total,
+			(channel(a, 2) * weightA + channel(b, 2) * weightB) / total, 255u);
+	}
+
+	void bc1_palette(std::uint16_t color0, std::uint16_t color1, std::array<std::uint32_t, 4>& palette) noexcept
+	{
+		palette[0] = expand_565(color0);
+		palette[1] = expand_565(color1);
+		if (color0 > color1)
+		{
+			palette[2] = blend_rgb(palette[0], palette[1], 2, 1);
+			palette[3] = blend_rgb(palette[0], palette[1], 1, 2);
+		}
+		else
+		{
+			palette[2] = blend_rgb(palette[0], palette[1], 1, 1);
+			palette[3] = 0;
+		}
+	}
+
+	void decode_bc1_block(std::uint64_t block, std::array<std::uint32_t, 16>& texels) noexcept
+	{
+		std::array<std::uint32_t, 4> palette;
+		bc1_palette(static_cast<std::uint16_t>(block), static_cast<std::uint16_t>(block >> 16), palette);
+		std::uint32_t indices = static_cast<std::uint32_t>(block >> 32);
+		for (std::uint32_t& texel : texels)
+		{
+			texel = palette[indices & 3u];
+			indices >>= 2;
+		}
+	}
+
+	// 범위 맞춤(range fit) 인코더: 불투명 texel의 RGB 경계 상자 대각선을 끝점으로
+	// 삼고, 양 끝을 범위의 1/16만큼 안쪽으로 당겨 양자화 오차를 줄인다. 주성분
+	// 분석보다 품질은 낮지만 블록당 비용이 작아 로드 시간에 부담이 없다.
+	[[nodiscard]] std::uint64_t encode_bc1_block(const std::array<std::uint32_t, 16>& texels) noexcept
+	{
+		int minColor[3] = { 255, 255, 255 };
+		int maxColor[3] = { 0, 0, 0 };
+		bool hasTransparent = false;
+		bool hasOpaque = false;
+		for (const std::uint32_t texel : texels)
+		{
+			if (channel(texel, 3) < 128u)
+			{
+				hasTransparent = true;
+				continue;
+			}
+			hasOpaque = true;
+			for (int c = 0; c < 3; ++c)
+			{
+				minColor[c] = std::min(minColor[c], static_cast<int>(channel(texel, c)));
+				maxColor[c] = std::max(maxColor[c], static_cast<int>(channel(texel, c)));
+			}
+		}
+
+		// 전부 투명하면 3색 모드에서 모든 인덱스를 3(투명 검정)으로 둔다.
+		if (!hasOpaque)
+			return 0xFFFFFFFF'00000000ull;
+
+		for (int c = 0; c < 3; ++c)
+		{
+			const int inset = (maxColor[c] - minColor[c]) >> 4;
+			minColor[c] += inset;
+			maxColor[c] -= inset;
+		}
+
+		std::uint16_t color0 = quantize_565(maxColor[0], maxColor[1], maxColor[2]);
+		std::uint16_t color1 = quantize_565(minColor[0], minColor[1], minColor[2]);
+		// 4색 모드는 color0 > color1, 투명 texel이 있으면 3색 모드(color0 <= color1)가 필요하다.
+		if (hasTransparent == (color0 > color1))
+			std::swap(color0, color1);
+
+		std::array<std::uint32_t, 4> palette;
+		bc1_palette(color0, color1, palette);
+		const int colorCount = color0 > color1 ? 4 : 3;
+
+		std::uint64_t indices = 0;
+		for (int i = 0; i < 16; ++i)
+		{
+			const std::uint32_t texel = texels[i];
+			std::uint64_t best = 3;
+			if (channel(texel, 3) >= 128u)
+			{
+				int bestDistance = std::numeric_limits<int>::max();
+				for (int p = 0; p < colorCount; ++p)
+				{
+					int distance = 0;
+					for (int c = 0; c < 3; ++c)
+					{
+						const int delta = static_cast<int>(channel(texel, c)) - static_cast<int>(channel(palette[p], c));
+						distance += delta * delta;
+					}
+					if (distance < bestDistance)
+					{
+						bestDistance = distance;
+						best = static_cast<std::uint64_t>(p);
+					}
+				}
+			}
+			indices |= best << (i * 2);
+		}
+
+		return static_cast<std::uint64_t>(color0) | (static_cast<std::uint64_t>(color1) << 16) | (indices << 32);
+	}
+}
 
 Texture::Texture() = default;
 Texture::~Texture() = default;
+Texture& Texture::operator=(Texture&&) noexcept = default;
+
+void Texture::ReplaceContents(Texture&& replacement) noexcept
+{
+	// 새 텍스처는 자기 BC1 캐시 id를 가져오므로 이전 이미지의 디코드 블록이 재사용되지 않는다.
+	*this = std::move(replacement);
+}
 
-SRMath::Color Texture::Sample(float u, float v) const noexcept
+// 표본 좌표를 texel 좌표로 바꾼다. 랩 모드와 2의 거듭제곱 여부가 템플릿
+// 인수이므로 인스턴스마다 한 가지 식만 남고 모드 분기는 생성되지 않는다.
+template <ETextureWrap Wrap, bool PowerOfTwo>
+Texture::TexelCoord Texture::wrapTexel(const Texture& texture, float u, float v) noexcept
 {
-	if (!m_pPixels || m_width == 0 || m_height == 0)
-		return {};
+	const int width = texture.m_width;
+	const int height = texture.m_height;
+	int x = 0;
+	int y = 0;
 
-	const int x = static_cast<int>(std::clamp(u, 0.0f, 1.0f) * (m_width - 1));
-	const int y = static_cast<int>(std::clamp(v, 0.0f, 1.0f) * (m_height - 1));
-	const std::size_t offset = (static_cast<std::size_t>(y) * m_width + x) * 4;
+	if constexpr (Wrap == ETextureWrap::Clamp)
+	{
+		// std::clamp는 minss/maxss로 내려가므로 비교 분기가 남지 않는다.
+		x = static_cast<int>(std::clamp(u, 0.0f, 1.0f) * (width - 1));
+		y = static_cast<int>(std::clamp(v, 0.0f, 1.0f) * (height - 1));
+	}
+	else if constexpr (PowerOfTwo)
+	{
+		// 2의 거듭제곱 크기는 texel 좌표를 내림한 뒤 비트마스크로 감싼다. 음수도
+		// 2의 보수 AND로 올바른 주기에 들어온다.
+		const int texelX = floor_to_int(u * static_cast<float>(width));
+		const int texelY = floor_to_int(v * static_cast<float>(height));
+		if constexpr (Wrap == ETextureWrap::Repeat)
+		{
+			x = texelX & (width - 1);
+			y = texelY & (height - 1);
+		}
+		else
+		{
+			// 2N 주기 안에서 뒤쪽 절반이면 모든 비트를 반전해 N-1-i로 접는다.
+			x = (texelX ^ -((texelX & width) != 0)) & (width - 1);
+			y = (texelY ^ -((texelY & height) != 0)) & (height - 1);
+		}
+	}
+	else
+	{
+		const float wrappedU = Wrap == ETextureWrap::Repeat ? repeat_unit(u) : mirror_unit(u);
+		const float wrappedV = Wrap == ETextureWrap::Repeat ? repeat_unit(v) : mirror_unit(v);
+		x = std::min(static_cast<int>(wrappedU * static_cast<float>(width)), width - 1);
+		y = std::min(static_cast<int>(wrappedV * static_cast<float>(height)), height - 1);
+	}
+
+	return { x, y };
+}
+
+template <ETextureWrap Wrap, bool PowerOfTwo>
+std::size_t Texture::texelIndex(const Texture& texture, float u, float v) noexcept
+{
+	const TexelCoord texel = wrapTexel<Wrap, PowerOfTwo>(texture, u, v);
+	return static_cast<std::size_t>(texel.y) * static_cast<std::size_t>(texture.m_width) + static_cast<std::size_t>(texel.x);
+}
+
+std::uint32_t Texture::fetchBC1Texel(const Texture& texture, TexelCoord texel) noexcept
+{
+	// 직접 사상(direct-mapped) 캐시. 인접 블록은 인접 슬롯에 놓이므로 한 삼각형
+	// 안의 연속 표본은 대부분 같은 슬롯을 다시 읽는다. 스레드마다 따로 두어
+	// 타일 작업자 사이에 동기화가 필요 없다.
+	thread_local std::array<DecodedBC1Block, bc1_cache_slots> decodedBlocks{};
+
+	const std::uint32_t blockIndex = static_cast<std::uint32_t>((texel.y >> 2) * texture.m_blocksPerRow + (texel.x >> 2));
+	const std::uint64_t key = (static_cast<std::uint64_t>(texture.m_blockCacheId) << 32) | blockIndex;
+	DecodedBC1Block& slot = decodedBlocks[(blockIndex ^ (texture.m_blockCacheId * 0x9E3779B1u)) & (bc1_cache_slots - 1)];
+	if (slot.key != key)
+	{
+		decode_bc1_block(texture.m_bc1Blocks[blockIndex], slot.texels);
+		slot.key = key;
+	}
+	return slot.texels[((texel.y & 3) << 2) | (texel.x & 3)];
+}
+
+template <ETextureFormat Format, ETextureWrap Wrap, bool PowerOfTwo>
+SRMath::Color4 Texture::sampleTexel(const Texture& texture, float u, float v) noexcept
+{
+	if constexpr (Format == ETextureFormat::BC1)
+	{
+		return unpack_bytes(fetchBC1Texel(texture, wrapTexel<Wrap, PowerOfTwo>(texture, u, v)));
+	}
+
+	const std::size_t texel = texelIndex<Wrap, PowerOfTwo>(texture, u, v);
+
+	if constexpr (Format == ETextureFormat::RGBA32F)
+	{
+		return texture.m_floatTexels[texel];
+	}
+	else if constexpr (Format == ETextureFormat::RGBA16F)
+	{
+		return half4_to_float4(texture.m_halfTexels[texel]);
+	}
+	else
+	{
+		// stbi_load(..., 4)는 메모리에 R,G,B,A 순서로 저장한다. 이전 구현은 네
+		// 바이트를 unsigned int로 묶은 뒤 float 한 값으로 변환해 텍스처가 거의
+		// 흰색이 되는 문제가 있었다. 채널 단위의 값 타입을 반환해 이를 막는다.
+		return unpack_bytes(load_rgba8(texture.m_pPixels.get() + texel * 4));
+	}
+}
+
+template <ETextureFormat Format>
+Texture::SampleFunction Texture::selectWrapSampler(ETextureWrap wrap, bool powerOfTwo) noexcept
+{
+	switch (wrap)
+	{
+	case ETextureWrap::Repeat:
+		return powerOfTwo ? &Texture::sampleTexel<Format, ETextureWrap::Repeat, true>
+			: &Texture::sampleTexel<Format, ETextureWrap::Repeat, false>;
+	case ETextureWrap::Mirror:
+		return powerOfTwo ? &Texture::sampleTexel<Format, ETextureWrap::Mirror, true>
+			: &Texture::sampleTexel<Format, ETextureWrap::Mirror, false>;
+	case ETextureWrap::Clamp:
+	default:
+		return &Texture::sampleTexel<Format, ETextureWrap::Clamp, false>;
+	}
+}
+
+void Texture::updateSampler() noexcept
+{
+	const bool hasTexels = m_width > 0 && m_height > 0 && (m_pPixels || !m_floatTexels.empty()
+		|| !m_halfTexels.empty() || !m_bc1Blocks.empty());
+	if (!hasTexels)
+	{
+		m_sample = &Texture::sampleEmpty;
+		return;
+	}
+
+	const bool powerOfTwo = std::has_single_bit(static_cast<unsigned int>(m_width))
+		&& std::has_single_bit(static_cast<unsigned int>(m_height));
+
+	switch (m_format)
+	{
+	case ETextureFormat::RGBA32F: m_sample = selectWrapSampler<ETextureFormat::RGBA32F>(m_wrap, powerOfTwo); break;
+	case ETextureFormat::RGBA16F: m_sample = selectWrapSampler<ETextureFormat::RGBA16F>(m_wrap, powerOfTwo); break;
+	case ETextureFormat::BC1: m_sample = selectWrapSampler<ETextureFormat::BC1>(m_wrap, powerOfTwo); break;
+	case ETextureFormat::RGBA8:
+	default: m_sample = selectWrapSampler<ETextureFormat::RGBA8>(m_wrap, powerOfTwo); break;
+	}
+
+}
+
+void Texture::SetWrapMode(ETextureWrap wrap) noexcept
+{
+	m_wrap = wrap;
+	updateSampler();
+}
+
+void Texture::SetPixels(StbiImagePtr pixels) noexcept
+{
+	m_pPixels = std::move(pixels);
+	m_floatTexels = {};
+	m_halfTexels = {};
+	m_bc1Blocks = {};
+	m_blocksPerRow = 0;
+	m_format = ETextureFormat::RGBA8;
+	updateSampler();
+}
+
+void Texture::ConvertTo(ETextureFormat format)
+{
+	if (format == ETextureFormat::RGBA16F && !SRMath::SIMD::f16c_available())
+		format = ETextureFormat::RGBA32F;
+	if (format == m_format || m_format != ETextureFormat::RGBA8 || !m_pPixels)
+		return;
+
+	const std::size_t texelCount = static_cast<std::size_t>(m_width) * static_cast<std::size_t>(m_height);
 	const auto* pixels = m_pPixels.get();
-	constexpr float byte_to_unit = 1.0f / 255.0f;
 
-	// stbi_load(..., 4)는 메모리에 R,G,B,A 순서로 저장한다. 이전 구현은 네
-	// 바이트를 unsigned int로 묶은 뒤 float 한 값으로 변환해 텍스처가 거의
-	// 흰색이 되는 문제가 있었다. 채널 단위의 값 타입을 반환해 이를 막는다.
-	return {
-		pixels[offset] * byte_to_unit,
-		pixels[offset + 1] * byte_to_unit,
-		pixels[offset + 2] * byte_to_unit
-	};
+	switch (format)
+	{
+	case ETextureFormat::RGBA32F:
+		m_floatTexels.resize(texelCount);
+		for (std::size_t i = 0; i < texelCount; ++i)
+			m_floatTexels[i] = unpack_bytes(load_rgba8(pixels + i * 4));
+		break;
+	case ETextureFormat::RGBA16F:
+		m_halfTexels.resize(texelCount);
+		for (std::size_t i = 0; i < texelCount; ++i)
+			m_halfTexels[i] = float4_to_half4(unpack_bytes(load_rgba8(pixels + i * 4)));
+		break;
+	case ETextureFormat::BC1:
+	{
+		// 블록 행마다 독립적으로 인코드할 수 있으므로 로드 시간의 대부분을 차지하는
+		// 끝점/인덱스 탐색을 행 단위로 병렬화한다.
+		const int blocksPerRow = (m_width + 3) / 4;
+		const int blockRows = (m_height + 3) / 4;
+		m_bc1Blocks.resize(static_cast<std::size_t>(blocksPerRow) * static_cast<std::size_t>(blockRows));
+		m_blocksPerRow = blocksPerRow;
+		tbb::parallel_for(tbb::blocked_range<int>(0, blockRows), [&](const tbb::blocked_range<int>& rows) {
+			std::array<std::uint32_t, 16> block{};
+			for (int blockY = rows.begin(); blockY < rows.end(); ++blockY)
+			{
+				for (int blockX = 0; blockX < blocksPerRow; ++blockX)
+				{
+					for (int i = 0; i < 16; ++i)
+					{
+						const int x = std::min(blockX * 4 + (i & 3), m_width - 1);
+						const int y = std::min(blockY * 4 + (i >> 2), m_height - 1);
+						block[i] = load_rgba8(pixels + (static_cast<std::size_t>(y) * m_width + x) * 4);
+					}
+					m_bc1Blocks[static_cast<std::size_t>(blockY) * blocksPerRow + blockX] = encode_bc1_block(block);
+				}
+			}
+		});
+		m_blockCacheId = next_block_cache_id.fetch_add(1, std::memory_order_relaxed);
+		break;
+	}
+	case ETextureFormat::RGBA8:
+	default:
+		return;
+	}
+
+	// 변환한 포맷만 남겨 메모리 사용을 한 벌로 유지한다.
+	m_pPixels.reset();
+	m_format = format;
+	updateSampler();
 }
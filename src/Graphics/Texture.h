@@ -1,16 +1,60 @@
 ﻿#pragma once
 #include "TextureLoader.h"
+#include "Graphics/TextureTypes.h"
 #include "Math/SRMath.h"
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
 #include <memory>
+#include <vector>
 
 class Texture
 {
-	friend std::expected<std::shared_ptr<Texture>, AssetLoadError> TextureLoader::LoadImageFile(const std::filesystem::path& filepath);
+	friend std::expected<std::shared_ptr<Texture>, AssetLoadError> TextureLoader::LoadImageFile(const std::filesystem::path& filepath, ETextureFormat format);
 
 private:
+	// 포맷/랩 모드별 표본 함수. 두 값은 로드/설정 시에만 바뀌므로 표본마다
+	// switch로 분기하지 않고 SIMD.cpp의 구현 선택처럼 함수 포인터 하나로 고정한다.
+	using SampleFunction = SRMath::Color4 (*)(const Texture&, float, float) noexcept;
+
+	struct TexelCoord
+	{
+		int x;
+		int y;
+	};
+
+	template <ETextureWrap Wrap, bool PowerOfTwo>
+	[[nodiscard]] static TexelCoord wrapTexel(const Texture& texture, float u, float v) noexcept;
+	template <ETextureWrap Wrap, bool PowerOfTwo>
+	[[nodiscard]] static std::size_t texelIndex(const Texture& texture, float u, float v) noexcept;
+	// BC1 블록을 디코드해 스레드별 캐시에 두고 해당 texel의 RGBA8 바이트를 돌려준다.
+	[[nodiscard]] static std::uint32_t fetchBC1Texel(const Texture& texture, TexelCoord texel) noexcept;
+	template <ETextureFormat Format, ETextureWrap Wrap, bool PowerOfTwo>
+	[[nodiscard]] static SRMath::Color4 sampleTexel(const Texture& texture, float u, float v) noexcept;
+	[[nodiscard]] static SRMath::Color4 sampleEmpty(const Texture&, float, float) noexcept { return {}; }
+	template <ETextureFormat Format>
+	[[nodiscard]] static SampleFunction selectWrapSampler(ETextureWrap wrap, bool powerOfTwo) noexcept;
+	void updateSampler() noexcept;
+	// ReplaceContents 전용. 공유 중인 객체의 내용을 바꾸므로 공개하지 않는다.
+	Texture& operator=(Texture&&) noexcept;
+
+	// RGBA8은 stb_image 버퍼를 그대로 쓰고, 다른 포맷은 변환 후 원본을 해제한다.
+	// 한 시점에 하나의 저장소만 채워지며 m_format이 어느 쪽인지 결정한다.
 	StbiImagePtr m_pPixels = nullptr;
+	std::vector<SRMath::Color4> m_floatTexels;		// RGBA32F
+	std::vector<std::uint64_t> m_halfTexels;		// RGBA16F (binary16 x 4)
+	std::vector<std::uint64_t> m_bc1Blocks;			// BC1, 행 우선 4x4 블록 (가장자리는 texel 복제)
+	int m_blocksPerRow = 0;
+	// 디코드 블록 캐시의 키. 블록 데이터를 만들 때마다 새 값을 받으므로 같은
+	// 주소에 다른 텍스처가 생겨도 이전 블록이 잘못 재사용되지 않는다.
+	std::uint32_t m_blockCacheId = 0;
 	int m_width = 0;
 	int m_height = 0;
+	bool m_hasAlpha = false;	// 원본 이미지에 alpha 채널이 있었는지 (없으면 stb가 255로 채운다)
+	std::filesystem::path m_sourcePath;	// 캐시/재로드가 같은 이미지를 다시 찾을 때 쓴다
+	ETextureFormat m_format = ETextureFormat::RGBA8;
+	ETextureWrap m_wrap = ETextureWrap::Clamp;
+	SampleFunction m_sample = &Texture::sampleEmpty;
 
 public:
 	Texture();
@@ -18,9 +62,24 @@ public:
 
 	// 정규화 UV를 가장 가까운 texel의 RGB 값으로 변환한다. packed 정수를
 	// 노출하지 않으므로 호출자가 픽셀 포맷/엔디언을 잘못 해석할 수 없다.
-	[[nodiscard]] SRMath::Color Sample(float u, float v) const noexcept;
+	[[nodiscard]] SRMath::Color Sample(float u, float v) const noexcept { return SRMath::Color{ m_sample(*this, u, v) }; }
+	[[nodiscard]] SRMath::Color4 SampleRGBA(float u, float v) const noexcept { return m_sample(*this, u, v); }
+
 	[[nodiscard]] int GetWidth() const noexcept { return m_width; }
 	[[nodiscard]] int GetHeight() const noexcept { return m_height; }
+	[[nodiscard]] ETextureFormat GetFormat() const noexcept { return m_format; }
+	[[nodiscard]] ETextureWrap GetWrapMode() const noexcept { return m_wrap; }
+	[[nodiscard]] bool HasAlphaChannel() const noexcept { return m_hasAlpha; }
+	[[nodiscard]] const std::filesystem::path& GetSourcePath() const noexcept { return m_sourcePath; }
+
+	void SetWrapMode(ETextureWrap wrap) noexcept;
+	// 핫 리로드: 다시 디코드한 이미지로 내용을 통째로 바꾼다. 이 텍스처를 공유하는
+	// 모든 재질이 새 이미지를 보게 되므로 렌더링 중이 아닐 때만 호출한다.
+	void ReplaceContents(Texture&& replacement) noexcept;
 
-	void SetPixels(StbiImagePtr pixels) noexcept { m_pPixels = std::move(pixels); }
+	void SetPixels(StbiImagePtr pixels) noexcept;
+	// RGBA8 원본에서 다른 내부 포맷으로 한 번만 변환한다. 원본 바이트는 해제되므로
+	// 이미 변환된 텍스처를 다시 바꾸려면 이미지를 새로 로드해야 한다.
+	// RGBA16F는 CPU가 F16C를 지원하지 않으면 RGBA32F로 대체된다.
+	void ConvertTo(ETextureFormat format);
 };
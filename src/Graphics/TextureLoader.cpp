@@ -3,7 +3,12 @@
 #include <charconv>
 #include <concepts>
 #include <fstream>
+#include <mutex>
 #include <string_view>
+#include <system_error>
+#include <utility>
+#include <vector>
+#include <tbb/parallel_for.h>
 
 #include "Material.h"
 #include "Texture.h"
@@ -70,6 +75,198 @@ namespace
         return SRMath::vec3{ *x, *y, *z };
     }
 
+    struct TextureMapStatement
+    {
+        std::string_view filename;
+        ETextureWrap wrap = ETextureWrap::Repeat;   // MTL 기본값은 "-clamp off"
+        float bumpMultiplier = 1.0f;                // -bm (map_Bump에서만 의미가 있다)
+    };
+
+    [[nodiscard]] constexpr std::string_view next_token(std::string_view& input) noexcept
+    {
+        input = trim_left(input);
+        const auto separator = input.find_first_of(" \t\r");
+        const auto token = input.substr(0, separator);
+        input = separator == std::string_view::npos ? std::string_view{} : input.substr(separator);
+        return token;
+    }
+
+    // "map_* [-옵션 인수...] 파일명"을 해석한다. 이 렌더러가 쓰지 않는 옵션도
+    // 인수 개수만큼 건너뛰어야 파일명을 잘못 읽지 않는다. -o/-s/-t는 u [v [w]]로
+    // 뒤쪽 인수가 생략될 수 있으므로 숫자인 동안만 소비한다.
+    [[nodiscard]] std::expected<TextureMapStatement, std::string_view>
+        parse_texture_map(std::string_view input) noexcept
+    {
+        TextureMapStatement statement;
+        input = trim_left(input);
+        while (input.starts_with('-'))
+        {
+            const auto option = next_token(input);
+            if (option == "-clamp")
+            {
+                const auto value = next_token(input);
+                if (value == "on") statement.wrap = ETextureWrap::Clamp;
+                else if (value == "off") statement.wrap = ETextureWrap::Repeat;
+                else return std::unexpected(option);
+            }
+            else if (option == "-bm")
+            {
+                auto value = parse_number<float>(input);
+                if (!value) return std::unexpected(option);
+                statement.bumpMultiplier = *value;
+            }
+            else if (option == "-blendu" || option == "-blendv" || option == "-cc"
+                || option == "-boost" || option == "-texres" || option == "-imfchan" || option == "-type")
+            {
+                if (next_token(input).empty()) return std::unexpected(option);
+            }
+            else if (option == "-mm")
+            {
+                if (!parse_number<float>(input) || !parse_number<float>(input)) return std::unexpected(option);
+            }
+            else if (option == "-o" || option == "-s" || option == "-t")
+            {
+                if (!parse_number<float>(input)) return std::unexpected(option);
+                for (int component = 0; component < 2; ++component)
+                {
+                    auto lookahead = input;
+                    if (!parse_number<float>(lookahead)) break;
+                    input = lookahead;
+                }
+            }
+            else
+            {
+                return std::unexpected(option);
+            }
+            input = trim_left(input);
+        }
+
+        // 파일명에는 공백이 있을 수 있으므로 줄의 나머지 전체를 쓴다.
+        while (!input.empty() && (input.back() == ' ' || input.back() == '\t' || input.back() == '\r'))
+        {
+            input.remove_suffix(1);
+        }
+        if (input.empty()) return std::unexpected(input);
+        statement.filename = input;
+        return statement;
+    }
+
+    // 법선 맵 명령의 철자들. -bm 배율을 받는 명령도 이 목록과 같다.
+    [[nodiscard]] constexpr bool is_bump_command(std::string_view command) noexcept
+    {
+        return command == "map_Bump" || command == "map_bump" || command == "bump" || command == "norm";
+    }
+
+    // 맵 명령이 채울 재질 슬롯. 텍스처 명령이 아니면 nullptr이다.
+    [[nodiscard]] std::shared_ptr<Texture>* texture_slot(Material& material, std::string_view command) noexcept
+    {
+        if (command == "map_Kd") return &material.diffuseTexture;
+        if (command == "map_Ks") return &material.specularTexture;
+        if (command == "map_Ns") return &material.shininessTexture;
+        if (is_bump_command(command)) return &material.normalTexture;
+        if (command == "map_d") return &material.opacityTexture;
+        return nullptr;
+    }
+
+    struct TextureCacheKey
+    {
+        std::filesystem::path path;
+        ETextureFormat format = ETextureFormat::RGBA8;
+        ETextureWrap wrap = ETextureWrap::Repeat;
+
+        [[nodiscard]] bool operator==(const TextureCacheKey&) const = default;
+    };
+
+    struct TextureCacheKeyHash
+    {
+        [[nodiscard]] std::size_t operator()(const TextureCacheKey& key) const noexcept
+        {
+            const std::size_t mode = (static_cast<std::size_t>(key.format) << 8) | static_cast<std::size_t>(key.wrap);
+            return std::filesystem::hash_value(key.path) ^ (mode * 0x9E3779B97F4A7C15ull);
+        }
+    };
+
+    // 모든 MTL 로드가 공유하는 텍스처 캐시. 약한 참조만 보관하므로 마지막 재질이
+    // 사라지면 이미지도 해제되고, 살아 있는 동안에는 같은 파일을 다시 디코드하지 않는다.
+    class TextureCache
+    {
+    private:
+        std::mutex m_mutex;
+        std::unordered_map<TextureCacheKey, std::weak_ptr<Texture>, TextureCacheKeyHash> m_entries;
+
+    public:
+        [[nodiscard]] std::shared_ptr<Texture> Find(const TextureCacheKey& key)
+        {
+            const std::lock_guard lock(m_mutex);
+            const auto found = m_entries.find(key);
+            return found != m_entries.end() ? found->second.lock() : nullptr;
+        }
+
+        // 경로가 같은 살아 있는 텍스처 전부(포맷/랩 모드별로 하나씩).
+        [[nodiscard]] std::vector<std::pair<TextureCacheKey, std::shared_ptr<Texture>>> FindAll(const std::filesystem::path& path)
+        {
+            std::vector<std::pair<TextureCacheKey, std::shared_ptr<Texture>>> found;
+            const std::lock_guard lock(m_mutex);
+            for (const auto& [key, entry] : m_entries)
+            {
+                if (key.path != path) continue;
+                if (auto texture = entry.lock())
+                    found.emplace_back(key, std::move(texture));
+            }
+            return found;
+        }
+
+        // 다른 로드가 먼저 같은 키를 등록했으면 그 텍스처를 돌려주어 사본이 남지 않게 한다.
+        [[nodiscard]] std::shared_ptr<Texture> Insert(const TextureCacheKey& key, std::shared_ptr<Texture> texture)
+        {
+            const std::lock_guard lock(m_mutex);
+            std::weak_ptr<Texture>& entry = m_entries[key];
+            if (auto existing = entry.lock())
+                return existing;
+            entry = texture;
+            return texture;
+        }
+    };
+
+    [[nodiscard]] TextureCache& texture_cache()
+    {
+        static TextureCache cache;
+        return cache;
+    }
+
+    // 같은 파일을 "a/../tex.png"와 "tex.png"처럼 다르게 참조해도 한 항목이 되도록 한다.
+    [[nodiscard]] std::filesystem::path normalize_texture_path(const std::filesystem::path& path)
+    {
+        std::error_code error;
+        auto canonical = std::filesystem::weakly_canonical(path, error);
+        return error ? path.lexically_normal() : canonical;
+    }
+
+    struct TextureRequest
+    {
+        TextureCacheKey key;
+        std::size_t line = 0;
+        // nullptr 값은 "파일 없음"으로 건너뛴 요청이다.
+        std::expected<std::shared_ptr<Texture>, AssetLoadError> result{};
+    };
+
+    // 파싱 중 만난 맵 명령 하나. 포맷은 재질의 sr_texture_format이 맵 줄보다 뒤에
+    // 와도 적용되도록 파일을 다 읽은 뒤 재질에서 가져온다.
+    struct TextureMapReference
+    {
+        std::shared_ptr<Texture>* slot = nullptr;
+        const Material* material = nullptr;
+        std::filesystem::path path;
+        ETextureWrap wrap = ETextureWrap::Repeat;
+        std::size_t line = 0;
+    };
+
+    struct TextureBinding
+    {
+        std::shared_ptr<Texture>* slot = nullptr;
+        std::size_t request = 0;
+    };
+
     [[nodiscard]] AssetLoadError malformed_mtl(const std::filesystem::path& path,
                                                 std::size_t line,
                                                 std::string_view command)
@@ -88,7 +285,7 @@ void StbiImageDeleter::operator()(unsigned char* pixels) const noexcept
 }
 
 std::expected<std::shared_ptr<Texture>, AssetLoadError>
-TextureLoader::LoadImageFile(const std::filesystem::path& filepath)
+TextureLoader::LoadImageFile(const std::filesystem::path& filepath, ETextureFormat format)
 {
     auto texture = std::make_shared<Texture>();
 
@@ -105,10 +302,48 @@ TextureLoader::LoadImageFile(const std::filesystem::path& filepath)
         });
     }
 
+    texture->m_hasAlpha = channels == 2 || channels == 4;
+    texture->m_sourcePath = filepath;
     texture->SetPixels(StbiImagePtr{ pixels });
+    texture->ConvertTo(format);
     return texture;
 }
 
+std::expected<std::shared_ptr<Texture>, AssetLoadError>
+TextureLoader::LoadTexture(const std::filesystem::path& filepath, ETextureFormat format, ETextureWrap wrap)
+{
+    const TextureCacheKey key{ normalize_texture_path(filepath), format, wrap };
+    if (auto cached = texture_cache().Find(key))
+        return cached;
+
+    // mtllib 누락과 같이 참조 파일이 없으면 텍스처 없이 계속한다.
+    // 파일은 있는데 디코드할 수 없으면 손상된 자산이므로 오류로 보고한다.
+    std::error_code existsError;
+    if (!std::filesystem::exists(key.path, existsError))
+        return std::shared_ptr<Texture>{};
+
+    auto texture = LoadImageFile(key.path, format);
+    if (!texture)
+        return std::unexpected(std::move(texture.error()));
+    (*texture)->SetWrapMode(wrap);
+    return texture_cache().Insert(key, std::move(*texture));
+}
+
+std::expected<std::vector<TextureReplacement>, AssetLoadError>
+TextureLoader::DecodeChangedImage(const std::filesystem::path& filepath)
+{
+    std::vector<TextureReplacement> replacements;
+    for (auto& [key, texture] : texture_cache().FindAll(normalize_texture_path(filepath)))
+    {
+        auto decoded = LoadImageFile(key.path, key.format);
+        if (!decoded)
+            return std::unexpected(std::move(decoded.error()));
+        (*decoded)->SetWrapMode(key.wrap);
+        replacements.push_back({ std::move(texture), std::move(*decoded) });
+    }
+    return replacements;
+}
+
 std::expected<std::unordered_map<std::string, Material>, AssetLoadError>
 TextureLoader::LoadMTLFile(const std::filesystem::path& filepath)
 {
@@ -122,6 +357,9 @@ TextureLoader::LoadMTLFile(const std::filesystem::path& filepath)
     materials.reserve(100);
 
     Material* currentMaterial = nullptr;
+    // unordered_map의 값은 rehash 후에도 주소가 유지되므로 재질/텍스처 슬롯 포인터를
+    // 파싱이 끝날 때까지 보관해도 안전하다.
+    std::vector<TextureMapReference> references;
     std::string line;
     std::size_t lineNumber = 0;
     while (std::getline(file, line))
@@ -175,6 +413,74 @@ TextureLoader::LoadMTLFile(const std::filesystem::path& filepath)
             if (!value) return std::unexpected(malformed_mtl(filepath, lineNumber, command));
             currentMaterial->illuminationModel = *value;
         }
+        else if (command == "sr_texture_format")
+        {
+            // 이 렌더러의 확장 명령: 재질의 텍스처를 어떤 내부 포맷으로 둘지 고른다.
+            auto remaining = arguments;
+            const auto format = ParseTextureFormat(next_token(remaining));
+            if (!format || !trim_left(remaining).empty()) return std::unexpected(malformed_mtl(filepath, lineNumber, command));
+            currentMaterial->textureFormat = *format;
+        }
+        else if (const auto slot = texture_slot(*currentMaterial, command))
+        {
+            const auto statement = parse_texture_map(arguments);
+            if (!statement) return std::unexpected(malformed_mtl(filepath, lineNumber, command));
+            if (is_bump_command(command))
+                currentMaterial->bumpMultiplier = statement->bumpMultiplier;
+
+            // 이미지는 여기서 바로 읽지 않고 참조만 모은다.
+            references.push_back({ slot, currentMaterial,
+                normalize_texture_path(filepath.parent_path() / std::filesystem::path(statement->filename)),
+                statement->wrap, lineNumber });
+        }
+    }
+
+    // 같은 파일/포맷/랩 조합을 여러 재질이 참조해도 한 번만 디코드하고,
+    // 서로 다른 조합은 아래에서 병렬로 읽는다.
+    std::vector<TextureRequest> requests;
+    std::unordered_map<TextureCacheKey, std::size_t, TextureCacheKeyHash> requestIndices;
+    std::vector<TextureBinding> bindings;
+    bindings.reserve(references.size());
+    for (TextureMapReference& reference : references)
+    {
+        TextureCacheKey key{ std::move(reference.path), reference.material->textureFormat, reference.wrap };
+        const auto [request, inserted] = requestIndices.try_emplace(key, requests.size());
+        if (inserted)
+            requests.push_back({ std::move(key), reference.line });
+        bindings.push_back({ reference.slot, request->second });
+    }
+
+    // 디코드가 로드 시간의 대부분이므로 고유 이미지 단위로 병렬 처리한다.
+    // stb_image의 실패 사유는 스레드 로컬이라 작업자마다 정확한 메시지를 얻는다.
+    tbb::parallel_for(std::size_t{ 0 }, requests.size(), [&requests](std::size_t i) {
+        TextureRequest& request = requests[i];
+        request.result = LoadTexture(request.key.path, request.key.format, request.key.wrap);
+    });
+
+    // 요청은 처음 등장한 줄 순서대로 쌓였으므로 순차 로더와 같은 첫 오류를 보고한다.
+    for (TextureRequest& request : requests)
+    {
+        if (!request.result)
+        {
+            // 메시지에는 이미지 경로가 들어 있으므로 위치는 참조한 MTL 줄로 보고한다.
+            AssetLoadError error = std::move(request.result.error());
+            error.path = filepath;
+            error.line = request.line;
+            return std::unexpected(std::move(error));
+        }
+    }
+
+    for (const TextureBinding& binding : bindings)
+    {
+        *binding.slot = *requests[binding.request].result;
+    }
+
+    // 전체가 반투명한 재질(d < 1)은 블렌딩, 불투명도 맵만 있는 재질은 알파
+    // 테스트로 분류한다. 둘 다 아니면 opacity를 읽지 않는 불투명 경로에 남긴다.
+    for (auto& [name, material] : materials)
+    {
+        if (material.opacity < 1.0f) material.alphaMode = EAlphaMode::Blend;
+        else if (material.opacityTexture) material.alphaMode = EAlphaMode::Mask;
     }
 
     return materials;
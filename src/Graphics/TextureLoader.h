@@ -3,7 +3,9 @@
 #include <filesystem>
 #include <unordered_map>
 #include <memory>
+#include <vector>
 #include "Utils/AssetLoadError.h"
+#include "Graphics/TextureTypes.h"
 
 struct StbiImageDeleter
 {
@@ -15,9 +17,24 @@ using StbiImagePtr = std::unique_ptr<unsigned char, StbiImageDeleter>;
 class Texture;
 struct Material;
 
+// 핫 리로드 결과 한 건. 렌더링이 없는 시점에 target->ReplaceContents(replacement)로 적용한다.
+struct TextureReplacement
+{
+	std::shared_ptr<Texture> target;		// 재질들이 공유하는 기존 텍스처
+	std::shared_ptr<Texture> replacement;	// 바뀐 파일에서 새로 디코드한 내용
+};
+
 class TextureLoader
 {
 public:
-	[[nodiscard]] static std::expected<std::shared_ptr<Texture>, AssetLoadError> LoadImageFile(const std::filesystem::path& filepath);
+	[[nodiscard]] static std::expected<std::shared_ptr<Texture>, AssetLoadError> LoadImageFile(const std::filesystem::path& filepath,
+		ETextureFormat format = ETextureFormat::RGBA8);
+	// 프로세스 공용 텍스처 캐시를 거쳐 이미지를 얻는다. 같은 경로/포맷/랩 모드의
+	// 텍스처가 살아 있으면 디코드하지 않고 공유한다. 파일이 없으면 nullptr을 돌려준다.
+	[[nodiscard]] static std::expected<std::shared_ptr<Texture>, AssetLoadError> LoadTexture(const std::filesystem::path& filepath,
+		ETextureFormat format, ETextureWrap wrap);
 	[[nodiscard]] static std::expected<std::unordered_map<std::string, Material>, AssetLoadError> LoadMTLFile(const std::filesystem::path& filepath);
+	// 파일이 바뀐 이미지를 캐시에 살아 있는 포맷/랩 조합마다 다시 디코드한다. 기존 텍스처는
+	// 건드리지 않으므로 렌더링과 동시에 호출할 수 있다. 쓰는 텍스처가 없으면 빈 목록이다.
+	[[nodiscard]] static std::expected<std::vector<TextureReplacement>, AssetLoadError> DecodeChangedImage(const std::filesystem::path& filepath);
 };
@@ -0,0 +1,47 @@
+﻿#pragma once
+#include <cstdint>
+#include <optional>
+#include <string_view>
+
+// Texture가 메모리에 유지하는 texel 배치. 로드 시 한 번 변환해 두면 표본마다
+// 반복되던 byte -> float 변환을 건너뛸 수 있다. 메모리와 처리량을 맞바꾸는
+// 선택이므로 재질(Material)마다 고를 수 있도록 Texture.h와 분리해 둔다.
+enum class ETextureFormat : std::uint8_t
+{
+	RGBA8,				// stb_image 원본 바이트 (4 B/texel, 표본마다 정규화)
+	RGBA32F,			// 미리 정규화한 float (16 B/texel, 표본 = 정렬된 load 한 번)
+	RGBA16F,			// binary16 (8 B/texel, F16C 변환 한 번)
+	BC1					// 4x4 블록당 565 끝점 두 개 + 2-bit 인덱스 (0.5 B/texel, 1-bit alpha)
+};
+
+// MTL 확장 명령 "sr_texture_format <이름>"과 도구 인수가 쓰는 포맷 이름.
+[[nodiscard]] constexpr std::optional<ETextureFormat> ParseTextureFormat(std::string_view name) noexcept
+{
+	if (name == "rgba8") return ETextureFormat::RGBA8;
+	if (name == "rgba32f") return ETextureFormat::RGBA32F;
+	if (name == "rgba16f") return ETextureFormat::RGBA16F;
+	if (name == "bc1") return ETextureFormat::BC1;
+	return std::nullopt;
+}
+
+[[nodiscard]] constexpr std::string_view TextureFormatName(ETextureFormat format) noexcept
+{
+	switch (format)
+	{
+	case ETextureFormat::RGBA32F: return "rgba32f";
+	case ETextureFormat::RGBA16F: return "rgba16f";
+	case ETextureFormat::BC1: return "bc1";
+	case ETextureFormat::RGBA8:
+	default: return "rgba8";
+	}
+}
+
+// 정규화 범위를 벗어난 UV의 처리 방식. MTL의 "-clamp on|off" 옵션에 대응하며
+// 기본값(off)은 반복이다. 모드는 템플릿 인수로 표본 함수에 고정되어 표본마다
+// 모드를 분기하지 않는다.
+enum class ETextureWrap : std::uint8_t
+{
+	Clamp,	// [0, 1]로 제한 (가장자리 texel 유지)
+	Repeat,	// 정수부를 버리고 타일링
+	Mirror	// 정수 구간마다 방향을 뒤집어 타일링
+};
@@ -122,14 +122,15 @@ bool AABB::IsValid() const noexcept
 
 AABB AABB::CreateFromMesh(const Mesh& mesh)
 {
-    if(mesh.vertices.empty())
+    const auto vertices = mesh.GetVertices();
+    if(vertices.empty())
     {
         return AABB{ {0, 0, 0}, {0, 0, 0} }; // 빈 메시의 경우, AABB는 (0,0,0)으로 설정
 	}
 
     AABB bounds;
 
-    for (const auto& vertex : mesh.vertices)
+    for (const auto& vertex : vertices)
     {
         bounds.min.x = std::min(bounds.min.x, vertex.position.x);
         bounds.min.y = std::min(bounds.min.y, vertex.position.y);
@@ -1,4 +1,5 @@
 ﻿#include "Frustum.h"
+#include <algorithm>
 
 void Frustum::Update(const SRMath::mat4& vpMatrix) noexcept
 {
@@ -48,6 +49,31 @@ void Frustum::Update(const SRMath::mat4& vpMatrix) noexcept
 		plane.normal = plane.normal / length;
 		plane.distance /= length;
 	}
+
+	for (std::size_t i = 0; i < planes.size(); ++i)
+	{
+		m_packedPlanes[i] = SRMath::vec4(planes[i].normal, planes[i].distance);
+	}
+}
+
+Frustum Frustum::ToObjectSpace(const SRMath::mat4& worldTransform) const noexcept
+{
+	// 월드 점 p = M * q이면 평면 식 dot(plane, p) = dot(M^T * plane, q)이므로
+	// 로컬 평면은 전치 행렬을 곱한 것이다. 비균등 스케일로 법선 길이가 바뀌므로 다시 정규화한다.
+	const SRMath::mat4 transposed = SRMath::transpose(worldTransform);
+	Frustum local;
+	for (std::size_t i = 0; i < planes.size(); ++i)
+	{
+		const SRMath::vec4 plane = transposed * m_packedPlanes[i];
+		const SRMath::vec3 normal{ plane.x, plane.y, plane.z };
+		const float length = SRMath::length(normal);
+		const float scale = length > 0.f ? 1.f / length : 1.f;
+
+		local.planes[i].normal = normal * scale;
+		local.planes[i].distance = plane.w * scale;
+		local.m_packedPlanes[i] = SRMath::vec4(local.planes[i].normal, local.planes[i].distance);
+	}
+	return local;
 }
 
 bool Frustum::IsAABBInFrustum(const AABB& aabb) const noexcept
@@ -71,3 +97,31 @@ bool Frustum::IsAABBInFrustum(const AABB& aabb) const noexcept
 	// 모든 평면 검사를 통과했다면, AABB는 절두체 안에 있거나 걸쳐 있습니다.
 	return true;
 }
+
+SRMath::SIMD::PlaneTestMask Frustum::TestAABBs(const SRMath::SIMD::AABBx8& boxes, std::uint32_t activePlanes) const noexcept
+{
+	return SRMath::SIMD::test_aabbs_x8(m_packedPlanes, boxes, activePlanes);
+}
+
+void Frustum::TestAABBs(std::span<const AABB> boxes, std::span<EFrustumTest> results) const noexcept
+{
+	constexpr std::size_t lane_count = SRMath::SIMD::AABBx8::lane_count;
+	for (std::size_t first = 0; first < boxes.size(); first += lane_count)
+	{
+		const std::size_t count = std::min(lane_count, boxes.size() - first);
+		SRMath::SIMD::AABBx8 batch;
+		for (std::size_t lane = 0; lane < count; ++lane)
+		{
+			batch.Set(lane, boxes[first + lane].min, boxes[first + lane].max);
+		}
+
+		const SRMath::SIMD::PlaneTestMask mask = TestAABBs(batch);
+		for (std::size_t lane = 0; lane < count; ++lane)
+		{
+			const std::uint32_t bit = 1u << lane;
+			results[first + lane] = (mask.inside & bit) != 0 ? EFrustumTest::Inside
+				: (mask.visible & bit) != 0 ? EFrustumTest::Intersecting
+				: EFrustumTest::Outside;
+		}
+	}
+}
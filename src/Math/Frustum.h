@@ -1,7 +1,10 @@
 ﻿#pragma once
 #include <array>
+#include <cstdint>
+#include <span>
 #include "Math/SRMath.h"
 #include "Math/AABB.h"
+#include "Math/SIMD.h"
 
 struct Plane
 {
@@ -14,12 +17,37 @@ struct Plane
 	}
 };
 
+// 배치 검사에서 상자 하나의 판정
+enum class EFrustumTest : std::uint8_t
+{
+	Outside,		// 어느 한 평면의 완전히 바깥
+	Intersecting,	// 절두체와 겹치지만 일부 평면에 걸쳐 있다
+	Inside			// 모든 평면 안쪽. 하위 상자는 검사하지 않아도 보인다
+};
+
 class Frustum
 {
+private:
+	// planes를 (법선, 거리) vec4로 묶은 사본. SIMD 배치 검사가 평면마다 그대로 브로드캐스트한다.
+	std::array<SRMath::vec4, 6> m_packedPlanes{};
+
 public:
 	// C 배열보다 std::array가 범위 알고리즘과 크기 안전성을 제공한다.
+	// Update만 값을 쓰며, 배치 검사용 사본도 그때 함께 갱신된다.
 	std::array<Plane, 6> planes{}; // Left, Right, Bottom, Top, Near, Far
 
 	void Update(const SRMath::mat4& viewProjectionMatrix) noexcept;
+	// worldTransform으로 배치된 물체의 로컬 공간에서 본 같은 절두체. 로컬 AABB를 월드로
+	// 변환하지 않고 그대로 검사할 수 있어, 노드마다 하던 꼭짓점 8개 변환이 평면 6개 변환으로 바뀐다.
+	[[nodiscard]] Frustum ToObjectSpace(const SRMath::mat4& worldTransform) const noexcept;
 	[[nodiscard]] bool IsAABBInFrustum(const AABB& aabb) const noexcept;
+
+	// planes 순서의 비트 집합. 계층 순회는 부모가 완전히 안쪽인 평면의 비트를 꺼서 넘긴다.
+	static constexpr std::uint32_t all_planes = (1u << 6) - 1;
+
+	// 상자 8개(빈 칸은 AABBx8 기본값)를 한 번의 SIMD 패스로 검사한다. activePlanes에 없는
+	// 평면은 검사하지 않고 통과한 것으로 본다.
+	[[nodiscard]] SRMath::SIMD::PlaneTestMask TestAABBs(const SRMath::SIMD::AABBx8& boxes, std::uint32_t activePlanes = all_planes) const noexcept;
+	// 임의 길이 배열을 8개씩 묶어 검사한다. results[i]가 boxes[i]의 판정이며 크기가 같아야 한다.
+	void TestAABBs(std::span<const AABB> boxes, std::span<EFrustumTest> results) const noexcept;
 };
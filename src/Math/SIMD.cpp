@@ -1,5 +1,6 @@
 #include "Math/SIMD.h"
 
+#include <algorithm>
 #include <array>
 #include <intrin.h>
 
@@ -46,12 +47,82 @@ namespace SRMath::SIMD
             return true;
         }
 
+        // Baseline implementation: 8개 칸을 128-bit 레지스터 두 번으로 나눠 검사한다.
+        [[nodiscard]] PlaneTestMask test_aabbs_x8_sse(std::span<const vec4> planes,
+                                                      const AABBx8& boxes,
+                                                      std::uint32_t activePlanes) noexcept
+        {
+            PlaneTestMask mask{};
+            const __m128 zero = _mm_setzero_ps();
+            for (std::size_t half = 0; half < AABBx8::lane_count; half += 4)
+            {
+                const __m128 minX = _mm_load_ps(boxes.minX.data() + half);
+                const __m128 minY = _mm_load_ps(boxes.minY.data() + half);
+                const __m128 minZ = _mm_load_ps(boxes.minZ.data() + half);
+                const __m128 maxX = _mm_load_ps(boxes.maxX.data() + half);
+                const __m128 maxY = _mm_load_ps(boxes.maxY.data() + half);
+                const __m128 maxZ = _mm_load_ps(boxes.maxZ.data() + half);
+
+                __m128 outside = zero;
+                __m128 crossing = zero;
+                for (std::size_t index = 0; index < planes.size(); ++index)
+                {
+                    if (((activePlanes >> index) & 1u) == 0)
+                    {
+                        continue;
+                    }
+
+                    // 꼭짓점 선택은 평면마다 한 번이므로 상자별 분기가 없다.
+                    const vec4& plane = planes[index];
+                    const bool positiveX = plane.x >= 0.f;
+                    const bool positiveY = plane.y >= 0.f;
+                    const bool positiveZ = plane.z >= 0.f;
+                    const __m128 normalX = _mm_set1_ps(plane.x);
+                    const __m128 normalY = _mm_set1_ps(plane.y);
+                    const __m128 normalZ = _mm_set1_ps(plane.z);
+                    const __m128 distance = _mm_set1_ps(plane.w);
+
+                    __m128 farthest = _mm_add_ps(distance, _mm_mul_ps(normalX, positiveX ? maxX : minX));
+                    farthest = _mm_add_ps(farthest, _mm_mul_ps(normalY, positiveY ? maxY : minY));
+                    farthest = _mm_add_ps(farthest, _mm_mul_ps(normalZ, positiveZ ? maxZ : minZ));
+                    __m128 nearest = _mm_add_ps(distance, _mm_mul_ps(normalX, positiveX ? minX : maxX));
+                    nearest = _mm_add_ps(nearest, _mm_mul_ps(normalY, positiveY ? minY : maxY));
+                    nearest = _mm_add_ps(nearest, _mm_mul_ps(normalZ, positiveZ ? minZ : maxZ));
+
+                    const __m128 crossesPlane = _mm_cmplt_ps(nearest, zero);
+                    outside = _mm_or_ps(outside, _mm_cmplt_ps(farthest, zero));
+                    crossing = _mm_or_ps(crossing, crossesPlane);
+                    mask.crossing |= static_cast<std::uint64_t>(_mm_movemask_ps(crossesPlane)) << (index * 8 + half);
+                }
+
+                const auto outsideBits = static_cast<std::uint32_t>(_mm_movemask_ps(outside));
+                const auto crossingBits = static_cast<std::uint32_t>(_mm_movemask_ps(crossing));
+                mask.visible |= (~outsideBits & 0xfu) << half;
+                mask.inside |= (~(outsideBits | crossingBits) & 0xfu) << half;
+            }
+            return mask;
+        }
+
+        [[nodiscard]] bool detect_f16c() noexcept
+        {
+            if (!avx_available())
+            {
+                return false;
+            }
+
+            std::array<int, 4> registers{};
+            __cpuidex(registers.data(), 1, 0);
+            constexpr int f16c_bit = 1 << 29;
+            return (registers[2] & f16c_bit) != 0;
+        }
     }
 
     // C++11의 raw 함수 포인터 문법을 읽기 쉬운 using 별칭으로 표현한다.
     // 상태를 가진 펑터가 아니라 동일 시그니처의 SSE/AVX 자유 함수 주소다.
     using TransformPairFunction = TransformPair (*)(const mat4&, const vec4&, const vec4&) noexcept;
 
+    using TestAABBsFunction = PlaneTestMask (*)(std::span<const vec4>, const AABBx8&, std::uint32_t) noexcept;
+
     [[nodiscard]] TransformPairFunction select_transform_pair() noexcept;
 
     [[nodiscard]] bool avx_available() noexcept
@@ -60,6 +131,12 @@ namespace SRMath::SIMD
         return available;
     }
 
+    [[nodiscard]] bool f16c_available() noexcept
+    {
+        static const bool available = detect_f16c();
+        return available;
+    }
+
     [[nodiscard]] TransformPair transform_pair(const mat4& matrix,
                                                const vec4& first,
                                                const vec4& second) noexcept
@@ -70,6 +147,16 @@ namespace SRMath::SIMD
         return implementation(matrix, first, second);
     }
 
+    [[nodiscard]] PlaneTestMask test_aabbs_x8_avx(std::span<const vec4>, const AABBx8&, std::uint32_t) noexcept;
+
+    [[nodiscard]] PlaneTestMask test_aabbs_x8(std::span<const vec4> planes,
+                                              const AABBx8& boxes,
+                                              std::uint32_t activePlanes) noexcept
+    {
+        static const TestAABBsFunction implementation = avx_available() ? test_aabbs_x8_avx : test_aabbs_x8_sse;
+        return implementation(planes.first(std::min(planes.size(), max_test_planes)), boxes, activePlanes);
+    }
+
     // AVX 구현은 SIMD_AVX.cpp만 /arch:AVX로 컴파일한다. 같은 번역 단위에
     // 두면 컴파일러가 baseline 함수에도 AVX를 자동 생성할 수 있기 때문이다.
     [[nodiscard]] TransformPair transform_pair_avx(const mat4&, const vec4&, const vec4&) noexcept;
@@ -1,5 +1,11 @@
 #pragma once
 
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+
 #include "Math/SRMath.h"
 
 namespace SRMath::SIMD
@@ -22,4 +28,70 @@ namespace SRMath::SIMD
     // 확인한다. CPU만 AVX를 지원하고 OS가 YMM 저장을 지원하지 않는 경우도
     // 안전하게 false를 반환해야 illegal-instruction 예외를 피할 수 있다.
     [[nodiscard]] bool avx_available() noexcept;
+
+    // F16C(VCVTPH2PS/VCVTPS2PH)는 VEX 인코딩이므로 AVX와 같은 OS 지원 조건에
+    // CPUID.1:ECX bit 29를 더해 확인한다. half 텍스처 포맷 선택에 사용한다.
+    [[nodiscard]] bool f16c_available() noexcept;
+
+    // 최대 8개 AABB를 성분별 배열(SoA)로 담는다. 한 성분의 8개 값이 AVX 레지스터
+    // 하나를 정확히 채운다. 쓰지 않는 칸은 min > max인 빈 상자로 남아 어느 평면에서든
+    // 바깥으로 판정된다.
+    struct AABBx8
+    {
+        static constexpr std::size_t lane_count = 8;
+
+        alignas(32) std::array<float, lane_count> minX = filled(std::numeric_limits<float>::max());
+        alignas(32) std::array<float, lane_count> minY = filled(std::numeric_limits<float>::max());
+        alignas(32) std::array<float, lane_count> minZ = filled(std::numeric_limits<float>::max());
+        alignas(32) std::array<float, lane_count> maxX = filled(std::numeric_limits<float>::lowest());
+        alignas(32) std::array<float, lane_count> maxY = filled(std::numeric_limits<float>::lowest());
+        alignas(32) std::array<float, lane_count> maxZ = filled(std::numeric_limits<float>::lowest());
+
+        void Set(std::size_t lane, const vec3& min, const vec3& max) noexcept
+        {
+            minX[lane] = min.x; minY[lane] = min.y; minZ[lane] = min.z;
+            maxX[lane] = max.x; maxY[lane] = max.y; maxZ[lane] = max.z;
+        }
+
+    private:
+        [[nodiscard]] static constexpr std::array<float, lane_count> filled(float value) noexcept
+        {
+            std::array<float, lane_count> lanes{};
+            lanes.fill(value);
+            return lanes;
+        }
+    };
+
+    // 한 번에 검사할 수 있는 평면 수. 평면별 결과가 crossing의 한 바이트를 차지한다.
+    inline constexpr std::size_t max_test_planes = 8;
+
+    // 비트 i가 AABBx8의 i번째 칸에 대응한다. visible은 모든 평면의 바깥에 있지 않은
+    // 상자, inside는 모든 평면의 안쪽에 완전히 들어가 하위 검사가 필요 없는 상자다.
+    // crossing은 바이트 p의 비트 i가 i번째 상자가 p번째 평면에 걸쳐 있음을 뜻한다.
+    struct PlaneTestMask
+    {
+        std::uint32_t visible;
+        std::uint32_t inside;
+        std::uint64_t crossing;
+
+        // lane칸 상자가 걸친 평면의 비트 집합. 그 상자 안의 상자는 이 평면들만 다시 검사하면 된다.
+        [[nodiscard]] std::uint32_t CrossedPlanes(std::size_t lane) const noexcept
+        {
+            std::uint32_t planes = 0;
+            for (std::size_t plane = 0; plane < max_test_planes; ++plane)
+            {
+                planes |= static_cast<std::uint32_t>((crossing >> (plane * 8 + lane)) & 1u) << plane;
+            }
+            return planes;
+        }
+    };
+
+    // 평면 방정식 (x, y, z, w) = (법선, 원점 거리) 목록에 대해 8개 AABB를 분기 없이
+    // 한 번에 검사한다. 법선 방향으로 가장 먼 꼭짓점이 평면 뒤에 있으면 바깥이고,
+    // 가장 가까운 꼭짓점까지 평면 앞에 있으면 그 평면에 대해 안쪽이다.
+    // activePlanes의 비트가 꺼진 평면은 이미 부모 상자가 완전히 안쪽이므로 건너뛰며,
+    // max_test_planes를 넘는 평면은 무시한다.
+    [[nodiscard]] PlaneTestMask test_aabbs_x8(std::span<const vec4> planes,
+                                              const AABBx8& boxes,
+                                              std::uint32_t activePlanes = ~0u) noexcept;
 }
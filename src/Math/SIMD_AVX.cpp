@@ -35,4 +35,59 @@ namespace SRMath::SIMD
             vec4{ secondResult }
         };
     }
+
+    // 8개 상자의 한 성분이 __m256 하나에 들어가므로 평면마다 곱셈-덧셈 두 벌과
+    // 비교 두 번으로 8개 상자를 모두 판정한다.
+    [[nodiscard]] PlaneTestMask test_aabbs_x8_avx(std::span<const vec4> planes,
+                                                  const AABBx8& boxes,
+                                                  std::uint32_t activePlanes) noexcept
+    {
+        const __m256 minX = _mm256_load_ps(boxes.minX.data());
+        const __m256 minY = _mm256_load_ps(boxes.minY.data());
+        const __m256 minZ = _mm256_load_ps(boxes.minZ.data());
+        const __m256 maxX = _mm256_load_ps(boxes.maxX.data());
+        const __m256 maxY = _mm256_load_ps(boxes.maxY.data());
+        const __m256 maxZ = _mm256_load_ps(boxes.maxZ.data());
+        const __m256 zero = _mm256_setzero_ps();
+
+        __m256 outside = zero;
+        __m256 crossing = zero;
+        std::uint64_t crossingByPlane = 0;
+        for (std::size_t index = 0; index < planes.size(); ++index)
+        {
+            if (((activePlanes >> index) & 1u) == 0)
+            {
+                continue;
+            }
+
+            const vec4& plane = planes[index];
+            const bool positiveX = plane.x >= 0.f;
+            const bool positiveY = plane.y >= 0.f;
+            const bool positiveZ = plane.z >= 0.f;
+            const __m256 normalX = _mm256_set1_ps(plane.x);
+            const __m256 normalY = _mm256_set1_ps(plane.y);
+            const __m256 normalZ = _mm256_set1_ps(plane.z);
+            const __m256 distance = _mm256_set1_ps(plane.w);
+
+            __m256 farthest = _mm256_add_ps(distance, _mm256_mul_ps(normalX, positiveX ? maxX : minX));
+            farthest = _mm256_add_ps(farthest, _mm256_mul_ps(normalY, positiveY ? maxY : minY));
+            farthest = _mm256_add_ps(farthest, _mm256_mul_ps(normalZ, positiveZ ? maxZ : minZ));
+            __m256 nearest = _mm256_add_ps(distance, _mm256_mul_ps(normalX, positiveX ? minX : maxX));
+            nearest = _mm256_add_ps(nearest, _mm256_mul_ps(normalY, positiveY ? minY : maxY));
+            nearest = _mm256_add_ps(nearest, _mm256_mul_ps(normalZ, positiveZ ? minZ : maxZ));
+
+            const __m256 crossesPlane = _mm256_cmp_ps(nearest, zero, _CMP_LT_OQ);
+            outside = _mm256_or_ps(outside, _mm256_cmp_ps(farthest, zero, _CMP_LT_OQ));
+            crossing = _mm256_or_ps(crossing, crossesPlane);
+            crossingByPlane |= static_cast<std::uint64_t>(_mm256_movemask_ps(crossesPlane)) << (index * 8);
+        }
+
+        const auto outsideBits = static_cast<std::uint32_t>(_mm256_movemask_ps(outside));
+        const auto crossingBits = static_cast<std::uint32_t>(_mm256_movemask_ps(crossing));
+        return {
+            ~outsideBits & 0xffu,
+            ~(outsideBits | crossingBits) & 0xffu,
+            crossingByPlane
+        };
+    }
 }
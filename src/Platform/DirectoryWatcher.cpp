@@ -0,0 +1,135 @@
+#include "Platform/DirectoryWatcher.h"
+
+#include <array>
+#include <string>
+#include <utility>
+
+#include "Platform/Win32Headers.h"
+
+namespace sr
+{
+    namespace
+    {
+        // ReadDirectoryChangesW 결과 버퍼. 네트워크 드라이브 한도(64KiB) 이하로 둔다.
+        constexpr DWORD notify_buffer_bytes = 32 * 1024;
+        constexpr DWORD notify_filter = FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_SIZE;
+    }
+
+    DirectoryWatcher::DirectoryWatcher(std::filesystem::path directory, Clock::duration settleTime,
+        void* directoryHandle, void* stopEvent)
+        : m_directory(std::move(directory)),
+          m_settleTime(settleTime),
+          m_directoryHandle(directoryHandle),
+          m_stopEvent(stopEvent)
+    {
+        m_worker = std::jthread([this](std::stop_token stop) { run(std::move(stop)); });
+    }
+
+    DirectoryWatcher::~DirectoryWatcher()
+    {
+        m_worker.request_stop();
+        if (m_worker.joinable()) m_worker.join();
+        CloseHandle(m_stopEvent);
+        CloseHandle(m_directoryHandle);
+    }
+
+    std::expected<std::unique_ptr<DirectoryWatcher>, AssetLoadError> DirectoryWatcher::Open(
+        const std::filesystem::path& directory, std::chrono::milliseconds settleTime)
+    {
+        std::error_code error;
+        auto absolute = std::filesystem::weakly_canonical(directory, error);
+        if (error) absolute = std::filesystem::absolute(directory);
+
+        const auto failure = [&absolute](const char* what) {
+            return std::unexpected(AssetLoadError{
+                std::string(what) + ": " + absolute.string() + " (Win32 error " + std::to_string(GetLastError()) + ")",
+                absolute
+            });
+        };
+
+        // 다른 프로그램의 저장/삭제를 막지 않도록 모든 공유 모드를 연다.
+        HANDLE handle = CreateFileW(absolute.c_str(), FILE_LIST_DIRECTORY,
+            FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING,
+            FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, nullptr);
+        if (handle == INVALID_HANDLE_VALUE) return failure("Unable to watch directory");
+
+        HANDLE stopEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+        if (!stopEvent)
+        {
+            auto result = failure("Unable to create watcher event");
+            CloseHandle(handle);
+            return result;
+        }
+
+        return std::unique_ptr<DirectoryWatcher>(new DirectoryWatcher(std::move(absolute), settleTime, handle, stopEvent));
+    }
+
+    void DirectoryWatcher::run(std::stop_token stop)
+    {
+        HANDLE directory = m_directoryHandle;
+        HANDLE stopEvent = m_stopEvent;
+        const std::stop_callback wake(stop, [stopEvent] { SetEvent(stopEvent); });
+
+        HANDLE readEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+        if (!readEvent) return;
+
+        // FILE_NOTIFY_INFORMATION은 DWORD 정렬을 요구한다.
+        alignas(DWORD) std::array<std::byte, notify_buffer_bytes> buffer;
+        while (!stop.stop_requested())
+        {
+            OVERLAPPED overlapped{};
+            overlapped.hEvent = readEvent;
+            ResetEvent(readEvent);
+            if (!ReadDirectoryChangesW(directory, buffer.data(), notify_buffer_bytes, TRUE, notify_filter,
+                nullptr, &overlapped, nullptr))
+                break;
+
+            const std::array<HANDLE, 2> waits{ readEvent, stopEvent };
+            const DWORD signaled = WaitForMultipleObjects(static_cast<DWORD>(waits.size()), waits.data(), FALSE, INFINITE);
+            DWORD bytes = 0;
+            if (signaled != WAIT_OBJECT_0)
+            {
+                // 중단 요청: 진행 중인 읽기를 취소하고 버퍼를 놓기 전에 완료를 기다린다.
+                CancelIoEx(directory, &overlapped);
+                GetOverlappedResult(directory, &overlapped, &bytes, TRUE);
+                break;
+            }
+            if (!GetOverlappedResult(directory, &overlapped, &bytes, FALSE))
+                break;
+
+            // 0바이트는 버퍼 넘침이다. 어떤 파일이 바뀌었는지 알 수 없으므로 이번 묶음은
+            // 버리고, 다음 저장에서 다시 알림을 받는다.
+            if (bytes == 0) continue;
+
+            const auto now = Clock::now();
+            const std::lock_guard lock(m_mutex);
+            for (DWORD offset = 0;;)
+            {
+                const auto* info = reinterpret_cast<const FILE_NOTIFY_INFORMATION*>(buffer.data() + offset);
+                if (info->Action != FILE_ACTION_REMOVED && info->Action != FILE_ACTION_RENAMED_OLD_NAME)
+                {
+                    const std::wstring_view name(info->FileName, info->FileNameLength / sizeof(WCHAR));
+                    m_changes.insert_or_assign((m_directory / name).lexically_normal(), now);
+                }
+                if (info->NextEntryOffset == 0) break;
+                offset += info->NextEntryOffset;
+            }
+        }
+        CloseHandle(readEvent);
+    }
+
+    std::vector<std::filesystem::path> DirectoryWatcher::TakeChanges()
+    {
+        std::vector<std::filesystem::path> settled;
+        const auto now = Clock::now();
+        const std::lock_guard lock(m_mutex);
+        std::erase_if(m_changes, [&](const auto& change) {
+            if (now - change.second < m_settleTime) return false;
+            std::error_code error;
+            if (std::filesystem::is_regular_file(change.first, error))
+                settled.push_back(change.first);
+            return true;
+        });
+        return settled;
+    }
+}
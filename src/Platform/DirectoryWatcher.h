@@ -0,0 +1,58 @@
+#pragma once
+
+#include <chrono>
+#include <expected>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "Utils/AssetLoadError.h"
+
+namespace sr
+{
+    // 디렉터리(하위 포함)의 파일 변경을 백그라운드 스레드에서 감시한다.
+    // 편집기는 저장 한 번에 잘라내기/쓰기/이름 바꾸기를 여러 번 하므로, 마지막
+    // 알림 뒤 settle 시간이 지난 경로만 TakeChanges로 한 번씩 돌려준다.
+    class DirectoryWatcher
+    {
+    private:
+        using Clock = std::chrono::steady_clock;
+
+        struct PathHash
+        {
+            [[nodiscard]] std::size_t operator()(const std::filesystem::path& path) const noexcept
+            {
+                return std::filesystem::hash_value(path);
+            }
+        };
+
+        std::filesystem::path m_directory;
+        Clock::duration m_settleTime;
+        void* m_directoryHandle = nullptr;  // HANDLE (windows.h를 공개 헤더로 전파하지 않는다)
+        void* m_stopEvent = nullptr;        // HANDLE
+
+        std::mutex m_mutex;
+        std::unordered_map<std::filesystem::path, Clock::time_point, PathHash> m_changes;   // 경로 -> 마지막 알림 시각
+
+        // 소멸자 본문이 먼저 중단을 요청하고 join한 뒤에 핸들을 닫는다.
+        std::jthread m_worker;
+
+        DirectoryWatcher(std::filesystem::path directory, Clock::duration settleTime, void* directoryHandle, void* stopEvent);
+        void run(std::stop_token stop);
+
+    public:
+        ~DirectoryWatcher();
+        DirectoryWatcher(const DirectoryWatcher&) = delete;
+        DirectoryWatcher& operator=(const DirectoryWatcher&) = delete;
+
+        [[nodiscard]] static std::expected<std::unique_ptr<DirectoryWatcher>, AssetLoadError> Open(
+            const std::filesystem::path& directory,
+            std::chrono::milliseconds settleTime = std::chrono::milliseconds{ 250 });
+
+        // 변경이 가라앉은 파일의 절대 경로. 삭제된 파일은 포함하지 않는다.
+        [[nodiscard]] std::vector<std::filesystem::path> TakeChanges();
+    };
+}
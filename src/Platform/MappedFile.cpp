@@ -0,0 +1,73 @@
+#include "Platform/MappedFile.h"
+
+#include <string>
+#include <utility>
+
+#include "Platform/Win32Headers.h"
+
+namespace sr
+{
+    MappedFile::MappedFile(MappedFile&& other) noexcept
+        : m_file(std::exchange(other.m_file, nullptr)),
+          m_mapping(std::exchange(other.m_mapping, nullptr)),
+          m_data(std::exchange(other.m_data, nullptr)),
+          m_size(std::exchange(other.m_size, 0))
+    {
+    }
+
+    MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+    {
+        if (this == &other) return *this;
+        reset();
+        m_file = std::exchange(other.m_file, nullptr);
+        m_mapping = std::exchange(other.m_mapping, nullptr);
+        m_data = std::exchange(other.m_data, nullptr);
+        m_size = std::exchange(other.m_size, 0);
+        return *this;
+    }
+
+    void MappedFile::reset() noexcept
+    {
+        // 뷰 -> 매핑 -> 파일 순서로 생성의 역순으로 해제한다.
+        if (m_data) UnmapViewOfFile(m_data);
+        if (m_mapping) CloseHandle(m_mapping);
+        if (m_file) CloseHandle(m_file);
+        m_data = nullptr;
+        m_mapping = nullptr;
+        m_file = nullptr;
+        m_size = 0;
+    }
+
+    std::expected<MappedFile, AssetLoadError> MappedFile::Open(const std::filesystem::path& path)
+    {
+        const auto failure = [&path](const char* what) {
+            return std::unexpected(AssetLoadError{
+                std::string(what) + ": " + path.string() + " (Win32 error " + std::to_string(GetLastError()) + ")",
+                path
+            });
+        };
+
+        MappedFile mapped;
+        // 순차 힌트는 읽기 전용 매핑에서 미리 읽기 크기를 키운다. 매핑은 캐시에서
+        // 복원한 메시가 살아 있는 동안 유지되므로, 편집기 저장이나 캐시 교체가
+        // 이 핸들 때문에 막히지 않도록 DirectoryWatcher처럼 모든 공유를 허용한다.
+        HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr,
+            OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file == INVALID_HANDLE_VALUE) return failure("Unable to open file");
+        mapped.m_file = file;
+
+        LARGE_INTEGER size{};
+        if (!GetFileSizeEx(file, &size)) return failure("Unable to query file size");
+        if (size.QuadPart == 0) return mapped;
+
+        HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!mapping) return failure("Unable to create file mapping");
+        mapped.m_mapping = mapping;
+
+        const void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        if (!view) return failure("Unable to map file");
+        mapped.m_data = static_cast<const char*>(view);
+        mapped.m_size = static_cast<std::size_t>(size.QuadPart);
+        return mapped;
+    }
+}
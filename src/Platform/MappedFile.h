@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <expected>
+#include <filesystem>
+#include <string_view>
+
+#include "Utils/AssetLoadError.h"
+
+namespace sr
+{
+    // 읽기 전용 파일 매핑. 파일, 매핑 객체, 뷰 세 핸들의 생성/해제 순서를 한
+    // RAII 타입이 소유한다. 큰 OBJ를 std::getline으로 복사하지 않고 페이지
+    // 캐시를 직접 읽으며, 여러 스레드가 서로 다른 구간을 동시에 파싱할 수 있다.
+    class MappedFile
+    {
+    private:
+        void* m_file = nullptr;     // HANDLE (windows.h를 공개 헤더로 전파하지 않는다)
+        void* m_mapping = nullptr;  // HANDLE
+        const char* m_data = nullptr;
+        std::size_t m_size = 0;
+
+        void reset() noexcept;
+
+    public:
+        MappedFile() = default;
+        ~MappedFile() { reset(); }
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+        MappedFile(MappedFile&& other) noexcept;
+        MappedFile& operator=(MappedFile&& other) noexcept;
+
+        // 빈 파일은 매핑을 만들 수 없으므로 빈 view를 가진 유효한 객체를 돌려준다.
+        [[nodiscard]] static std::expected<MappedFile, AssetLoadError> Open(const std::filesystem::path& path);
+
+        [[nodiscard]] std::string_view View() const noexcept { return { m_data, m_size }; }
+        [[nodiscard]] std::size_t Size() const noexcept { return m_size; }
+    };
+}
@@ -0,0 +1,297 @@
+﻿#include "OcclusionBuffer.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <immintrin.h>
+#include "Graphics/Mesh.h"
+
+namespace
+{
+	struct ScreenPoint
+	{
+		float x;
+		float y;
+	};
+
+	// 렌더러와 같은 클립 공간 규약(OpenGL식 z ∈ [-w, w])에서 근평면 앞에 있는가
+	[[nodiscard]] bool in_front_of_near_plane(const SRMath::vec4& clip) noexcept
+	{
+		return clip.w > 0.f && clip.z >= -clip.w;
+	}
+
+	// NDC를 버퍼 픽셀 좌표로 옮긴다. y는 아래로 증가한다.
+	[[nodiscard]] ScreenPoint to_screen(const SRMath::vec4& clip) noexcept
+	{
+		const float inverseW = 1.f / clip.w;
+		return {
+			(clip.x * inverseW * 0.5f + 0.5f) * static_cast<float>(OcclusionBuffer::width),
+			(0.5f - clip.y * inverseW * 0.5f) * static_cast<float>(OcclusionBuffer::height)
+		};
+	}
+
+	// 4칸 중 [first, last] 열에 속한 칸의 비트
+	[[nodiscard]] int column_mask(int blockX, int first, int last) noexcept
+	{
+		int mask = 0;
+		for (int lane = 0; lane < 4; ++lane)
+		{
+			const int x = blockX + lane;
+			if (x >= first && x <= last) mask |= 1 << lane;
+		}
+		return mask;
+	}
+}
+
+OcclusionBuffer::OcclusionBuffer()
+	: m_viewProjection(SRMath::mat4::identity()),
+	  m_depth(static_cast<std::size_t>(width) * height, std::numeric_limits<float>::max()),
+	  m_tileMinDepth(static_cast<std::size_t>(tiles_x) * tiles_y, std::numeric_limits<float>::max()),
+	  m_tileMaxDepth(static_cast<std::size_t>(tiles_x) * tiles_y, std::numeric_limits<float>::max())
+{
+}
+
+void OcclusionBuffer::Clear(const SRMath::mat4& viewProjection)
+{
+	m_viewProjection = viewProjection;
+	if (m_hasOccluders)
+	{
+		std::ranges::fill(m_depth, std::numeric_limits<float>::max());
+		std::ranges::fill(m_tileMinDepth, std::numeric_limits<float>::max());
+		std::ranges::fill(m_tileMaxDepth, std::numeric_limits<float>::max());
+	}
+	m_hasOccluders = false;
+}
+
+void OcclusionBuffer::RasterizeMesh(const Mesh& mesh, const SRMath::mat4& worldTransform)
+{
+	const auto vertices = mesh.GetVertices();
+	const auto indices = mesh.GetIndices();
+	const SRMath::mat4 mvp = m_viewProjection * worldTransform;
+
+	// 정점은 여러 삼각형이 공유하므로 한 번씩만 변환한다.
+	m_clipPositions.resize(vertices.size());
+	for (std::size_t i = 0; i < vertices.size(); ++i)
+	{
+		m_clipPositions[i] = mvp * SRMath::vec4(vertices[i].position, 1.0f);
+	}
+
+	for (std::size_t i = 0; i + 2 < indices.size(); i += 3)
+	{
+		rasterizeTriangle(m_clipPositions[indices[i]], m_clipPositions[indices[i + 1]], m_clipPositions[indices[i + 2]]);
+	}
+	updateDirtyTiles();
+}
+
+void OcclusionBuffer::RasterizeTriangles(const Mesh& mesh, std::span<const unsigned int> indices, const SRMath::mat4& worldTransform)
+{
+	const auto vertices = mesh.GetVertices();
+	const SRMath::mat4 mvp = m_viewProjection * worldTransform;
+
+	for (std::size_t i = 0; i + 2 < indices.size(); i += 3)
+	{
+		rasterizeTriangle(mvp * SRMath::vec4(vertices[indices[i]].position, 1.0f),
+			mvp * SRMath::vec4(vertices[indices[i + 1]].position, 1.0f),
+			mvp * SRMath::vec4(vertices[indices[i + 2]].position, 1.0f));
+	}
+	updateDirtyTiles();
+}
+
+// 삼각형의 화면 경계 안을 한 행씩, 4픽셀씩 SSE로 훑으며 세 변의 edge function이 모두
+// 0 이상인 픽셀의 깊이를 삼각형의 가장 먼 깊이와의 최솟값으로 갱신한다.
+void OcclusionBuffer::rasterizeTriangle(const SRMath::vec4& clip0, const SRMath::vec4& clip1, const SRMath::vec4& clip2) noexcept
+{
+	if (!in_front_of_near_plane(clip0) || !in_front_of_near_plane(clip1) || !in_front_of_near_plane(clip2)) return;
+
+	const ScreenPoint a = to_screen(clip0);
+	const ScreenPoint b = to_screen(clip1);
+	const ScreenPoint c = to_screen(clip2);
+
+	// NDC에서 앞면은 시계 방향(렌더러의 후면 컬링 참고)이고, y를 뒤집은 버퍼 좌표에서는 반시계라
+	// 넓이가 양수다. 렌더러가 그리지 않는 뒷면은 아무것도 가리지 않는다.
+	const float area = (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+	if (!(area > 0.f)) return;
+
+	// 픽셀 i의 중심은 i + 0.5다. 중심이 삼각형 경계 상자 안에 있는 픽셀만 훑는다.
+	const int minX = std::max(0, static_cast<int>(std::ceil(std::min({ a.x, b.x, c.x }) - 0.5f)));
+	const int maxX = std::min(width - 1, static_cast<int>(std::floor(std::max({ a.x, b.x, c.x }) - 0.5f)));
+	const int minY = std::max(0, static_cast<int>(std::ceil(std::min({ a.y, b.y, c.y }) - 0.5f)));
+	const int maxY = std::min(height - 1, static_cast<int>(std::floor(std::max({ a.y, b.y, c.y }) - 0.5f)));
+	if (minX > maxX || minY > maxY) return;
+	m_dirtyMinX = std::min(m_dirtyMinX, minX);
+	m_dirtyMinY = std::min(m_dirtyMinY, minY);
+	m_dirtyMaxX = std::max(m_dirtyMaxX, maxX);
+	m_dirtyMaxY = std::max(m_dirtyMaxY, maxY);
+
+	// 변 p→q의 edge function E(x, y) = A·x + B·y + C. 세 변 모두 안쪽이 양수다.
+	struct Edge
+	{
+		float a;
+		float b;
+		float c;
+	};
+	const auto makeEdge = [](const ScreenPoint& p, const ScreenPoint& q) {
+		const float edgeA = p.y - q.y;
+		const float edgeB = q.x - p.x;
+		return Edge{ edgeA, edgeB, -(edgeA * p.x + edgeB * p.y) };
+	};
+	const std::array<Edge, 3> edges{ makeEdge(a, b), makeEdge(b, c), makeEdge(c, a) };
+
+	const __m128 depth = _mm_set1_ps(std::max({ clip0.w, clip1.w, clip2.w }));
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 laneOffsets = _mm_set_ps(3.5f, 2.5f, 1.5f, 0.5f);
+	std::array<__m128, 3> stepX{};
+	for (std::size_t e = 0; e < edges.size(); ++e)
+	{
+		stepX[e] = _mm_set1_ps(edges[e].a * 4.f);
+	}
+
+	// 너비가 4의 배수라서 4칸 묶음이 행 밖으로 나가지 않는다.
+	const int firstBlock = minX & ~3;
+	for (int y = minY; y <= maxY; ++y)
+	{
+		const float centerY = static_cast<float>(y) + 0.5f;
+		const __m128 firstX = _mm_add_ps(_mm_set1_ps(static_cast<float>(firstBlock)), laneOffsets);
+		std::array<__m128, 3> values{};
+		for (std::size_t e = 0; e < edges.size(); ++e)
+		{
+			values[e] = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(edges[e].a), firstX), _mm_set1_ps(edges[e].b * centerY + edges[e].c));
+		}
+
+		float* row = m_depth.data() + static_cast<std::size_t>(y) * width;
+		for (int x = firstBlock; x <= maxX; x += 4)
+		{
+			const __m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(values[0], zero), _mm_cmpge_ps(values[1], zero)),
+				_mm_cmpge_ps(values[2], zero));
+			if (_mm_movemask_ps(inside) != 0)
+			{
+				const __m128 current = _mm_loadu_ps(row + x);
+				const __m128 nearer = _mm_min_ps(current, depth);
+				_mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(inside, nearer), _mm_andnot_ps(inside, current)));
+				m_hasOccluders = true;
+			}
+
+			for (std::size_t e = 0; e < edges.size(); ++e)
+			{
+				values[e] = _mm_add_ps(values[e], stepX[e]);
+			}
+		}
+	}
+}
+
+// 상자를 투영한 화면 사각형을 타일 단위로 훑는다. 타일의 최댓값이 상자의 가장 가까운 깊이보다
+// 작으면 타일 전체가 가리고, 최솟값이 상자의 가장 먼 깊이보다 크면 타일 전체가 상자 뒤에 있다.
+// 둘 다 아닌 타일만 픽셀을 4칸씩 읽는다. 일부라도 보이면서 일부가 가려질 수 있으면 바로 Visible이다.
+EOcclusionTest OcclusionBuffer::TestAABB(const AABB& localBounds, const SRMath::mat4& worldTransform) const noexcept
+{
+	if (!m_hasOccluders) return EOcclusionTest::Unoccluded;
+
+	const SRMath::mat4 mvp = m_viewProjection * worldTransform;
+	float minX = std::numeric_limits<float>::max();
+	float minY = std::numeric_limits<float>::max();
+	float maxX = std::numeric_limits<float>::lowest();
+	float maxY = std::numeric_limits<float>::lowest();
+	float nearest = std::numeric_limits<float>::max();
+	float farthest = 0.f;
+	for (const SRMath::vec3& corner : localBounds.Corners())
+	{
+		const SRMath::vec4 clip = mvp * SRMath::vec4(corner, 1.0f);
+		// 근평면에 걸친 상자는 화면 사각형을 정할 수 없으므로 보이는 것으로 둔다.
+		if (!in_front_of_near_plane(clip)) return EOcclusionTest::Visible;
+
+		const ScreenPoint point = to_screen(clip);
+		minX = std::min(minX, point.x);
+		minY = std::min(minY, point.y);
+		maxX = std::max(maxX, point.x);
+		maxY = std::max(maxY, point.y);
+		nearest = std::min(nearest, clip.w);
+		farthest = std::max(farthest, clip.w);
+	}
+
+	// 사각형에 조금이라도 걸친 픽셀을 모두 포함한다.
+	const int firstX = std::max(0, static_cast<int>(std::floor(minX)));
+	const int lastX = std::min(width - 1, static_cast<int>(std::floor(maxX)));
+	const int firstY = std::max(0, static_cast<int>(std::floor(minY)));
+	const int lastY = std::min(height - 1, static_cast<int>(std::floor(maxY)));
+	if (firstX > lastX || firstY > lastY) return EOcclusionTest::Occluded; // 화면 밖
+
+	const __m128 nearestDepth = _mm_set1_ps(nearest);
+	const __m128 farthestDepth = _mm_set1_ps(farthest);
+	bool anyVisible = false;
+	bool allUnoccluded = true;
+	for (int tileY = firstY / tile_size; tileY <= lastY / tile_size; ++tileY)
+	{
+		for (int tileX = firstX / tile_size; tileX <= lastX / tile_size; ++tileX)
+		{
+			const std::size_t tile = static_cast<std::size_t>(tileY) * tiles_x + tileX;
+			if (m_tileMaxDepth[tile] < nearest)
+			{
+				allUnoccluded = false;
+			}
+			else if (m_tileMinDepth[tile] > farthest)
+			{
+				anyVisible = true;
+			}
+			else
+			{
+				const int x0 = std::max(firstX, tileX * tile_size);
+				const int x1 = std::min(lastX, tileX * tile_size + tile_size - 1);
+				const int y0 = std::max(firstY, tileY * tile_size);
+				const int y1 = std::min(lastY, tileY * tile_size + tile_size - 1);
+				for (int y = y0; y <= y1; ++y)
+				{
+					const float* row = m_depth.data() + static_cast<std::size_t>(y) * width;
+					for (int x = x0 & ~3; x <= x1; x += 4)
+					{
+						const int lanes = column_mask(x, x0, x1);
+						const __m128 occluder = _mm_loadu_ps(row + x);
+						anyVisible = anyVisible || (_mm_movemask_ps(_mm_cmpge_ps(occluder, nearestDepth)) & lanes) != 0;
+						allUnoccluded = allUnoccluded && (_mm_movemask_ps(_mm_cmpgt_ps(occluder, farthestDepth)) & lanes) == lanes;
+					}
+				}
+			}
+
+			if (anyVisible && !allUnoccluded) return EOcclusionTest::Visible;
+		}
+	}
+
+	if (!anyVisible) return EOcclusionTest::Occluded;
+	return allUnoccluded ? EOcclusionTest::Unoccluded : EOcclusionTest::Visible;
+}
+
+void OcclusionBuffer::updateDirtyTiles() noexcept
+{
+	if (m_dirtyMinX > m_dirtyMaxX || m_dirtyMinY > m_dirtyMaxY) return;
+
+	for (int tileY = m_dirtyMinY / tile_size; tileY <= m_dirtyMaxY / tile_size; ++tileY)
+	{
+		for (int tileX = m_dirtyMinX / tile_size; tileX <= m_dirtyMaxX / tile_size; ++tileX)
+		{
+			__m128 minimum = _mm_set1_ps(std::numeric_limits<float>::max());
+			__m128 maximum = _mm_setzero_ps();
+			for (int y = tileY * tile_size; y < (tileY + 1) * tile_size; ++y)
+			{
+				const float* row = m_depth.data() + static_cast<std::size_t>(y) * width + tileX * tile_size;
+				for (int x = 0; x < tile_size; x += 4)
+				{
+					const __m128 depth = _mm_loadu_ps(row + x);
+					minimum = _mm_min_ps(minimum, depth);
+					maximum = _mm_max_ps(maximum, depth);
+				}
+			}
+
+			alignas(16) std::array<float, 4> minimumLanes{};
+			alignas(16) std::array<float, 4> maximumLanes{};
+			_mm_store_ps(minimumLanes.data(), minimum);
+			_mm_store_ps(maximumLanes.data(), maximum);
+			const std::size_t tile = static_cast<std::size_t>(tileY) * tiles_x + tileX;
+			m_tileMinDepth[tile] = std::ranges::min(minimumLanes);
+			m_tileMaxDepth[tile] = std::ranges::max(maximumLanes);
+		}
+	}
+
+	m_dirtyMinX = width;
+	m_dirtyMinY = height;
+	m_dirtyMaxX = -1;
+	m_dirtyMaxY = -1;
+}
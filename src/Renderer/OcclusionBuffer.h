@@ -0,0 +1,68 @@
+﻿#pragma once
+#include <cstdint>
+#include <span>
+#include <vector>
+#include "Math/SRMath.h"
+#include "Math/AABB.h"
+
+struct Mesh;
+
+// 오클루전 버퍼에 대한 상자 하나의 판정
+enum class EOcclusionTest : std::uint8_t
+{
+	Occluded,	// 상자가 덮는 모든 픽셀에서 오클루더가 상자보다 가깝다
+	Visible,	// 일부 픽셀에서라도 상자가 오클루더보다 앞에 있을 수 있다
+	Unoccluded	// 덮는 모든 픽셀에서 상자 전체가 오클루더보다 앞이다. 안에 든 상자도 가려지지 않는다
+};
+
+// 프레임마다 가까운 오클루더 메시를 저해상도로 래스터라이즈한 깊이 버퍼. 오브젝트와 메시 컬링
+// 구조의 노드를 렌더 명령으로 만들기 전에 이 버퍼와 비교해, 완전히 가려진 것은 제출하지 않는다.
+//
+// 깊이는 클립 공간 w(시선 방향 거리)다. 픽셀에는 그 중심을 덮는 앞면 삼각형들 중 가장 가까운 것의
+// '가장 먼 정점' 깊이를 기록하고, 상자는 '가장 가까운 꼭짓점' 깊이로 비교하므로 깊이 방향으로는
+// 보수적이다. 다만 픽셀 중심만 샘플링하므로 저해상도 픽셀보다 가는 틈으로 보이는 물체는 가려진
+// 것으로 판정될 수 있다.
+class OcclusionBuffer
+{
+public:
+	static constexpr int width = 256;
+	static constexpr int height = 128;
+	// 타일마다 깊이 최솟값/최댓값을 두어 큰 상자는 픽셀 대신 타일 단위로 판정한다.
+	static constexpr int tile_size = 8;
+	static constexpr int tiles_x = width / tile_size;
+	static constexpr int tiles_y = height / tile_size;
+
+	OcclusionBuffer();
+
+	// 버퍼를 비우고 이번 프레임의 뷰-프로젝션 행렬을 기억한다.
+	void Clear(const SRMath::mat4& viewProjection);
+	// 메시의 앞면 삼각형을 오클루더로 그린다. 렌더러가 근평면에서 잘라낼 삼각형은 잘린 부분이
+	// 아무것도 가리지 않으므로 건너뛴다.
+	void RasterizeMesh(const Mesh& mesh, const SRMath::mat4& worldTransform);
+	// 메시 인덱스 버퍼의 일부 구간만 오클루더로 그린다. 정점을 삼각형마다 변환하므로
+	// 메시의 작은 부분을 그릴 때 RasterizeMesh보다 싸다.
+	void RasterizeTriangles(const Mesh& mesh, std::span<const unsigned int> indices, const SRMath::mat4& worldTransform);
+
+	// localBounds를 worldTransform으로 놓은 상자를 지금까지 그린 오클루더와 비교한다.
+	// 월드 AABB는 단위 행렬과 함께 넘긴다. 여러 스레드에서 동시에 불러도 된다.
+	[[nodiscard]] EOcclusionTest TestAABB(const AABB& localBounds, const SRMath::mat4& worldTransform) const noexcept;
+
+private:
+	SRMath::mat4 m_viewProjection;
+	std::vector<float> m_depth;	// width * height, 위쪽 행부터
+	std::vector<float> m_tileMinDepth;	// tiles_x * tiles_y
+	std::vector<float> m_tileMaxDepth;
+	bool m_hasOccluders = false;	// 비어 있으면 검사 없이 Unoccluded
+
+	// 이번 RasterizeMesh가 쓴 픽셀 범위. 끝나면 이 범위의 타일 값만 다시 구한다.
+	int m_dirtyMinX = width;
+	int m_dirtyMinY = height;
+	int m_dirtyMaxX = -1;
+	int m_dirtyMaxY = -1;
+
+	// RasterizeMesh가 재사용하는 정점별 클립 좌표
+	std::vector<SRMath::vec4> m_clipPositions;
+
+	void rasterizeTriangle(const SRMath::vec4& clip0, const SRMath::vec4& clip1, const SRMath::vec4& clip2) noexcept;
+	void updateDirtyTiles() noexcept;
+};
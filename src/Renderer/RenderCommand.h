@@ -2,6 +2,7 @@
 #include "Math/SRMath.h"
 #include "Math/AABB.h"
 #include "Utils/DebugUtils.h"
+#include <cstdint>
 #include <vector>
 #include <span>
 
@@ -13,16 +14,29 @@ enum class ERasterizeMode {
 struct Mesh;
 struct Material;
 
+// 씬 인스턴스 버퍼의 한 항목. 같은 Model을 공유하는 GameObject마다 하나씩 있고,
+// 그 인스턴스가 제출한 모든 메시 명령이 인덱스로 가리킨다.
+struct RenderInstance {
+	SRMath::mat4 worldTransform; // 월드 변환 행렬
+	SRMath::mat4 normalMatrix; // 법선 행렬 (역전치 행렬)
+};
+
 // 메시 렌더링을 위한 요청서
 struct MeshRenderCommand {
 	// 두 포인터와 span은 비소유 뷰이며 한 프레임 동안 원본 Model이 살아 있다.
 	// nullptr 기본값은 미완성 명령을 디버거에서 즉시 식별하게 한다.
 	const Mesh* sourceMesh = nullptr;
 	std::span<const unsigned int> indicesToDraw; // 렌더링할 인덱스들
-	SRMath::mat4 worldTransform; // 월드 변환 행렬
+	// 변환 행렬은 명령마다 복사하지 않고 RenderQueue의 인스턴스 버퍼에서 찾는다.
+	std::uint32_t instanceIndex = 0;
 	const Material* material = nullptr; // 메시의 재질
 
 	ERasterizeMode rasterizeMode = ERasterizeMode::Fill; // 래스터화 모드
+
+	// 이 명령의 픽셀이 하나라도 깊이 검사를 통과하면 렌더러가 가리키는 바이트에 feedback_drawn을
+	// 켠다. 가속 구조 순회가 인스턴스별 노드 기록을 가리키게 해 다음 프레임에 읽는다.
+	static constexpr std::uint8_t feedback_drawn = 1;
+	std::uint8_t* visibilityFeedback = nullptr;
 };
 
 // 디버그용 렌더링을 위한 요청서
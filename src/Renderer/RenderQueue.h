@@ -1,5 +1,6 @@
 ﻿#pragma once
 
+#include <cstdint>
 #include <vector>
 #include <span>
 #include <utility>
@@ -8,6 +9,8 @@
 class RenderQueue {
 private:
 	std::vector<MeshRenderCommand> m_renderCommands;
+	// 씬 전체의 인스턴스 버퍼. 인스턴스 수천 개가 같은 메시를 그려도 명령에는 인덱스만 남는다.
+	std::vector<RenderInstance> m_instances;
 	std::vector<DebugPrimitiveCommand> m_debugPrimitiveCmds;
 
 public:
@@ -22,8 +25,16 @@ public:
 		m_debugPrimitiveCmds.push_back(std::move(cmd));
 	}
 
+	// 인스턴스를 버퍼에 추가하고 메시 명령이 가리킬 인덱스를 돌려준다.
+	// 메시 명령을 만드는 병렬 구간에 들어가기 전에 호출한다.
+	[[nodiscard]] std::uint32_t AddInstance(const RenderInstance& instance) {
+		m_instances.push_back(instance);
+		return static_cast<std::uint32_t>(m_instances.size() - 1);
+	}
+
 	void Clear() {
 		m_renderCommands.clear();
+		m_instances.clear();
 		m_debugPrimitiveCmds.clear();
 	}
 
@@ -31,6 +42,10 @@ public:
 		return m_renderCommands;
 	}
 
+	[[nodiscard]] std::span<const RenderInstance> GetInstances() const noexcept {
+		return m_instances;
+	}
+
 	[[nodiscard]] std::span<const DebugPrimitiveCommand> GetDebugCommands() const noexcept {
 		return m_debugPrimitiveCmds;
 	}
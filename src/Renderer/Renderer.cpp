@@ -1,17 +1,18 @@
 ﻿#include "Renderer.h"
 #include <array>
+#include <atomic>
+#include <cstdint>
 #include <vector>
 #include <algorithm>
 #include <limits>
 #include <cmath>
-#include <unordered_map>
 #include <utility>
 #include <tbb/tbb.h>
 
 #include "Graphics/Mesh.h"
 #include "Graphics/Texture.h"
 #include "Math/AABB.h"
-#include "Graphics/Octree.h"
+#include "Graphics/AccelerationStructure.h"
 #include "Math/Frustum.h"
 #include "Scene/Camera.h"
 #include "Graphics/light.h"
@@ -23,6 +24,75 @@
 
 constexpr std::size_t max_triangles_per_thread_pool = 10'000;
 
+namespace
+{
+    // 한 픽셀의 재질 입력. 모든 맵을 같은 UV로 한 번에 읽어 셰이딩에 넘긴다.
+    struct MaterialSample
+    {
+        SRMath::vec3 baseColor;
+        SRMath::vec3 specular;
+        float shininess = 0.0f;
+        SRMath::vec3 tangentNormal;     // [-1, 1] 접선 공간 법선 (normalTexture가 있을 때만 유효)
+    };
+
+    // 맵마다 별도 패스를 두지 않고 픽셀당 한 번 호출한다. 각 텍스처는 포맷/랩
+    // 모드가 고정된 표본 함수를 쓰므로 여기서의 분기는 "맵이 있는가"뿐이며
+    // 재질 단위로 일정해 분기 예측이 거의 항상 맞는다.
+    [[nodiscard]] MaterialSample sample_material(const Material& material, const SRMath::vec2& uv) noexcept
+    {
+        MaterialSample sample{ material.diffuse, material.specular, material.shininess };
+
+        if (material.diffuseTexture)
+            sample.baseColor *= material.diffuseTexture->Sample(uv.x, uv.y);
+        if (material.specularTexture)
+            sample.specular *= material.specularTexture->Sample(uv.x, uv.y);
+        if (material.shininessTexture)
+            sample.shininess *= material.shininessTexture->SampleRGBA(uv.x, uv.y).x;
+        if (material.normalTexture)
+        {
+            SRMath::vec3 encoded = material.normalTexture->Sample(uv.x, uv.y);
+            encoded *= 2.0f;
+            encoded -= SRMath::vec3{ 1.0f, 1.0f, 1.0f };
+            encoded *= SRMath::vec3{ material.bumpMultiplier, material.bumpMultiplier, 1.0f };
+            sample.tangentNormal = encoded;
+        }
+        return sample;
+    }
+
+    // 불투명도는 셰이딩 전에 알파 테스트로 픽셀을 버릴 수 있도록 따로 읽는다.
+    // alpha가 있는 이미지는 alpha를, 회색조 마스크는 R 채널을 불투명도로 쓴다.
+    [[nodiscard]] float sample_opacity(const Material& material, const SRMath::vec2& uv) noexcept
+    {
+        if (!material.opacityTexture) return material.opacity;
+        const SRMath::Color4 mask = material.opacityTexture->SampleRGBA(uv.x, uv.y);
+        return material.opacity * (material.opacityTexture->HasAlphaChannel() ? mask.w : mask.x);
+    }
+
+    // 위치/UV 변화량으로 삼각형의 월드 접선을 구한다. 접선은 정점마다 저장하지
+    // 않고 법선 맵이 있는 재질의 삼각형에서만 계산한다.
+    [[nodiscard]] TangentFrame compute_tangent_frame(const ShadedVertex& sv0, const ShadedVertex& sv1, const ShadedVertex& sv2) noexcept
+    {
+        const SRMath::vec3 edge1 = sv1.posWorld - sv0.posWorld;
+        const SRMath::vec3 edge2 = sv2.posWorld - sv0.posWorld;
+        const SRMath::vec2 deltaUV1 = sv1.texcoord - sv0.texcoord;
+        const SRMath::vec2 deltaUV2 = sv2.texcoord - sv0.texcoord;
+
+        const float determinant = deltaUV1.x * deltaUV2.y - deltaUV2.x * deltaUV1.y;
+        if (std::abs(determinant) < 1e-12f) return {};
+
+        const float inverse = 1.0f / determinant;
+        const SRMath::vec3 tangent = (edge1 * deltaUV2.y - edge2 * deltaUV1.y) * inverse;
+        const SRMath::vec3 bitangent = (edge2 * deltaUV1.x - edge1 * deltaUV2.x) * inverse;
+        const SRMath::vec3 averageNormal = sv0.normalWorld + sv1.normalWorld + sv2.normalWorld;
+
+        TangentFrame frame;
+        frame.tangent = tangent;
+        frame.handedness = SRMath::dot(SRMath::cross(averageNormal, tangent), bitangent) < 0.0f ? -1.0f : 1.0f;
+        frame.valid = SRMath::dot(tangent, tangent) > 0.0f;
+        return frame;
+    }
+}
+
 Renderer::GdiBackBuffer::GdiBackBuffer(GdiBackBuffer&& other) noexcept
     : m_memoryDc(std::exchange(other.m_memoryDc, nullptr)),
       m_bitmap(std::exchange(other.m_bitmap, nullptr)),
@@ -505,10 +575,13 @@ void Renderer::RenderScene(const RenderQueue& queue, const Camera& camera, std::
             auto& myThreadClipBuffer1 = m_threadClipBuffer1.local();
             auto& myThreadClipBuffer2 = m_threadClipBuffer2.local();
             auto& myThreadClippedVertices = m_threadClippedVertices.local();
-            auto& myThreadNormalMatrixCache = m_threadNormalMatrixCache.local();  // 역행렬 캐시
 
 			thread_local std::uint64_t lastCleaned_frame =
 				std::numeric_limits<std::uint64_t>::max();
+            // 이 스레드가 직전에 셰이딩한 (메시, 인스턴스) 묶음과 그 스탬프
+            thread_local const Mesh* lastBatchMesh = nullptr;
+            thread_local std::uint32_t lastBatchInstance = 0;
+            thread_local std::uint64_t lastBatchStamp = 0;
 
             if (lastCleaned_frame != m_frameCounter) {
 
@@ -516,7 +589,7 @@ void Renderer::RenderScene(const RenderQueue& queue, const Camera& camera, std::
                 myThreadClipBuffer1.clear();
                 myThreadClipBuffer2.clear();
                 myThreadClippedVertices.clear();
-                myThreadNormalMatrixCache.clear();
+                lastBatchMesh = nullptr;
 
                 lastCleaned_frame = m_frameCounter;
 			}
@@ -525,19 +598,24 @@ void Renderer::RenderScene(const RenderQueue& queue, const Camera& camera, std::
             {
                 const auto& cmd = queue.GetRenderCommands()[cmd_idx];
                 const Mesh* mesh = cmd.sourceMesh;
-                const SRMath::mat4& worldTransform = cmd.worldTransform;
+                // 법선 행렬은 인스턴스마다 GameObject가 한 번 구해 두었다.
+                const RenderInstance& instance = queue.GetInstances()[cmd.instanceIndex];
+                const SRMath::mat4& worldTransform = instance.worldTransform;
+                const SRMath::mat4& inverseTransposeWorld = instance.normalMatrix;
                 const SRMath::mat4 mvp = vp * worldTransform;
 
-                if (myThreadNormalMatrixCache.find(&cmd) == myThreadNormalMatrixCache.end())
-                    myThreadNormalMatrixCache.try_emplace(&cmd, SRMath::inverse_transpose(worldTransform).value_or(SRMath::mat4(1.f)));
-
-                const SRMath::mat4 inverseTransposeWorld = myThreadNormalMatrixCache.at(&cmd);
-
-                const auto& vertices = mesh->vertices;
+                const auto vertices = mesh->GetVertices();
                 const auto indices = cmd.indicesToDraw; // 실제 그릴 인덱스 목록
 
-                const std::uint64_t myStamp =
-					(m_frameCounter << 32) | static_cast<std::uint64_t>(cmd_idx);
+                // 같은 인스턴스의 같은 메시를 그리는 옥트리 노드 명령이 연달아 오면 스탬프를
+                // 이어 써서, 노드 경계에 걸린 정점을 다시 셰이딩하지 않고 캐시에서 가져온다.
+                if (mesh != lastBatchMesh || cmd.instanceIndex != lastBatchInstance)
+                {
+                    lastBatchMesh = mesh;
+                    lastBatchInstance = cmd.instanceIndex;
+                    lastBatchStamp = (m_frameCounter << 32) | static_cast<std::uint64_t>(cmd_idx);
+                }
+                const std::uint64_t myStamp = lastBatchStamp;
 
                 // --- High-Watermark 로직으로 캐시 크기 관리 ---
                 if (myThreadShadedVertex.size() < vertices.size())
@@ -775,18 +853,71 @@ void Renderer::renderTile(int tx, int ty, const tbb::concurrent_vector<TriangleR
     int tileMaxX = std::min(tileMinX + tile_size, m_width);
     int tileMaxY = std::min(tileMinY + tile_size, m_height);
     
+    // 불투명/알파 테스트 패스. 반투명 삼각형은 최종 깊이가 정해진 뒤에 그려야
+    // 하므로 여기서는 건너뛰고 존재 여부만 기록한다.
+    bool hasTransparent = false;
     for (const auto& triRef : triangleBin)
     {
         const MeshRenderCommand* cmd = triRef->sourceCommand;
+        if (cmd->material->alphaMode == EAlphaMode::Blend && cmd->rasterizeMode == ERasterizeMode::Fill)
+        {
+            hasTransparent = true;
+            continue;
+        }
 
         // 래스터라이제이션
         resterizationForTile(triRef->sv0, triRef->sv1, triRef->sv2, cmd->material, lights, camPos,
-            *cmd, tileMinX, tileMinY, tileMaxX, tileMaxY);
+            *cmd, tileMinX, tileMinY, tileMaxX, tileMaxY, nullptr);
+    }
+
+    if (!hasTransparent) return;
+
+    // 반투명 패스. 누적 버퍼는 타일 크기로 고정되어 스택에 두며, 순서와 무관한
+    // 가중 합이므로 bin 안의 삼각형 순서(스레드마다 다름)가 결과를 바꾸지 않는다.
+    TileTransparencyBuffer transparency;
+    transparency.reset();
+    for (const auto& triRef : triangleBin)
+    {
+        const MeshRenderCommand* cmd = triRef->sourceCommand;
+        if (cmd->material->alphaMode != EAlphaMode::Blend || cmd->rasterizeMode != ERasterizeMode::Fill) continue;
+
+        resterizationForTile(triRef->sv0, triRef->sv1, triRef->sv2, cmd->material, lights, camPos,
+            *cmd, tileMinX, tileMinY, tileMaxX, tileMaxY, &transparency);
+    }
+
+    resolveTileTransparency(transparency, tileMinX, tileMinY, tileMaxX, tileMaxY);
+}
+
+void Renderer::resolveTileTransparency(const TileTransparencyBuffer& transparency, int tileMinX, int tileMinY, int tileMaxX, int tileMaxY)
+{
+    for (int y = tileMinY; y < tileMaxY; ++y)
+    {
+        for (int x = tileMinX; x < tileMaxX; ++x)
+        {
+            const int local = (y - tileMinY) * tile_size + (x - tileMinX);
+            const float revealage = transparency.revealage[local];
+            if (revealage >= 1.0f) continue;
+
+            // 가중 평균색을 (1 - 투과율)만큼 불투명 결과 위에 덮는다.
+            const SRMath::vec4& accumulated = transparency.accumulation[local];
+            const float inverseWeight = 1.0f / std::max(accumulated.w, 1e-5f);
+            const float coverage = 1.0f - revealage;
+
+            // 백버퍼 픽셀은 0x00RRGGBB이다 (drawPixel 참고).
+            unsigned int& pixel = m_pPixelData[y * m_width + x];
+            const auto composite = [&](int shift, float transparentChannel) {
+                const float opaqueChannel = static_cast<float>((pixel >> shift) & 0xFFu) * (1.0f / 255.0f);
+                const float blended = std::clamp(transparentChannel * inverseWeight * coverage + opaqueChannel * revealage, 0.0f, 1.0f);
+                return static_cast<unsigned int>(blended * 255.0f + 0.5f) << shift;
+            };
+            pixel = composite(16, accumulated.x) | composite(8, accumulated.y) | composite(0, accumulated.z);
+        }
     }
 }
 
 void Renderer::resterizationForTile(const ShadedVertex& sv0, const ShadedVertex& sv1, const ShadedVertex& sv2, const Material* material,
-    std::span<const DirectionalLight> lights, const SRMath::vec3& camPos, const MeshRenderCommand& cmd, int tileMinX, int tileMinY, int tileMaxX, int tileMaxY)
+    std::span<const DirectionalLight> lights, const SRMath::vec3& camPos, const MeshRenderCommand& cmd, int tileMinX, int tileMinY, int tileMaxX, int tileMaxY,
+    TileTransparencyBuffer* transparency)
 {
     // 모든 클리핑된 정점에 대해 원근 분할 및 뷰포트 변환을 먼저 수행합니다.
     RasterizerVertex rv0, rv1, rv2;
@@ -823,16 +954,24 @@ void Renderer::resterizationForTile(const ShadedVertex& sv0, const ShadedVertex&
     
     // 래스터라이저는 이제 화면 좌표와 원근 보정된 속성들을 받습니다.
     if (cmd.rasterizeMode == ERasterizeMode::Fill)
-        drawFilledTriangleForTile(rv0, rv1, rv2, material, lights, camPos, 
-            tileMinX, tileMinY, tileMaxX, tileMaxY);
+    {
+        const TangentFrame tangentFrame = material->normalTexture
+            ? compute_tangent_frame(sv0, sv1, sv2) : TangentFrame{};
+        const bool drawn = drawFilledTriangleForTile(rv0, rv1, rv2, material, tangentFrame, lights, camPos,
+            tileMinX, tileMinY, tileMaxX, tileMaxY, transparency);
+
+        // 여러 타일 스레드가 같은 명령의 기록 위치를 공유하므로 원자적으로 OR한다.
+        if (drawn && cmd.visibilityFeedback)
+            std::atomic_ref<std::uint8_t>(*cmd.visibilityFeedback).fetch_or(MeshRenderCommand::feedback_drawn, std::memory_order_relaxed);
+    }
     else
         drawTriangle(rv0.screenPos, rv1.screenPos, rv2.screenPos, RGB(255, 255, 255));
 }
 
 // drawFilledTriangle 함수 수정
-void Renderer::drawFilledTriangleForTile(const RasterizerVertex& v0, const RasterizerVertex& v1, const RasterizerVertex& v2,
-    const Material* material, std::span<const DirectionalLight> lights, const SRMath::vec3& camPos,
-    int tileMinX, int tileMinY, int tileMaxX, int tileMaxY)
+bool Renderer::drawFilledTriangleForTile(const RasterizerVertex& v0, const RasterizerVertex& v1, const RasterizerVertex& v2,
+    const Material* material, const TangentFrame& tangentFrame, std::span<const DirectionalLight> lights, const SRMath::vec3& camPos,
+    int tileMinX, int tileMinY, int tileMaxX, int tileMaxY, TileTransparencyBuffer* transparency)
 {
     // 정점 좌표를 정수로 변환 (화면 픽셀 기준)
     const SRMath::vec2 p0 = { v0.screenPos.x, v0.screenPos.y };
@@ -867,7 +1006,7 @@ void Renderer::drawFilledTriangleForTile(const RasterizerVertex& v0, const Raste
     const int finalMaxY = std::min(triMaxY, tileMaxY - 1);
 
     // 교차 영역이 없으면 바로 종료
-    if (finalMinX > finalMaxX || finalMinY > finalMaxY) return;
+    if (finalMinX > finalMaxX || finalMinY > finalMaxY) return false;
 
     // --- 사전 계산 단계 ---
     // 각 변(edge)의 x, y 변화량을 미리 계산해 둡니다.
@@ -895,6 +1034,8 @@ void Renderer::drawFilledTriangleForTile(const RasterizerVertex& v0, const Raste
 	SRMath::Fixed8 w1Row_fixed = SRMath::Fixed8(w1Row);
 	SRMath::Fixed8 w2Row_fixed = SRMath::Fixed8(w2Row);
 
+    bool drawn = false;
+
     // --- 래스터화 루프 ---
     for (int y = finalMinY; y <= finalMaxY; ++y)
     {
@@ -903,7 +1044,9 @@ void Renderer::drawFilledTriangleForTile(const RasterizerVertex& v0, const Raste
         SRMath::Fixed8 w1_fixed = w1Row_fixed;
         SRMath::Fixed8 w2_fixed = w2Row_fixed;
 
-        for (int x = finalMinX; x <= finalMaxX; ++x)
+        // x가 1 증가할 때마다 y의 변화량만큼 더한다 (점진적 계산). 증분을 루프
+        // 헤더에 두어 continue로 픽셀을 건너뛰어도 edge 값이 어긋나지 않는다.
+        for (int x = finalMinX; x <= finalMaxX; ++x, w0_fixed += dy12_fixed, w1_fixed += dy20_fixed, w2_fixed += dy01_fixed)
         {
             // 바리센트릭 좌표가 모두 양수이면 삼각형 내부에 있는 것입니다.
             if ((w0_fixed.value | w1_fixed.value | w2_fixed.value) >= 0)
@@ -930,27 +1073,39 @@ void Renderer::drawFilledTriangleForTile(const RasterizerVertex& v0, const Raste
                 {
 					float oneOverInterpolatedOneOverW = 1.0f / interpolatedOneOverW;
 
-                    SRMath::vec3 normalInterpolated = v0.normalWorldOverW * wBary;
-                                 normalInterpolated += v1.normalWorldOverW * uBary;
-                                 normalInterpolated += v2.normalWorldOverW * vBary;
-                                 normalInterpolated *= oneOverInterpolatedOneOverW;
-                    normalInterpolated = SRMath::normalize(normalInterpolated);
-
                     SRMath::vec2 uvOverWInterpolated = v0.texcoordOverW * wBary;
                                  uvOverWInterpolated += v1.texcoordOverW * uBary;
                                  uvOverWInterpolated += v2.texcoordOverW * vBary;
                     
                     SRMath::vec2 uv_interpolated = uvOverWInterpolated * oneOverInterpolatedOneOverW;
 
-                    SRMath::vec3 base_color;
-
-                    if (material->diffuseTexture)
+                    // 알파 테스트는 법선 보간/조명 전에 끝내 버려질 픽셀의 셰이딩 비용을 없앤다.
+                    // 불투명 재질은 불투명도 맵을 읽지 않는다.
+                    float opacity = 1.0f;
+                    if (material->alphaMode != EAlphaMode::Opaque)
                     {
-                        base_color = material->diffuseTexture->Sample(uv_interpolated.x, uv_interpolated.y);
-                        base_color *= material->diffuse;
+                        opacity = sample_opacity(*material, uv_interpolated);
+                        if (material->alphaMode == EAlphaMode::Mask && opacity < material->alphaCutoff) continue;
                     }
-                    else {
-                        base_color = material->diffuse;
+                    drawn = true;
+
+                    SRMath::vec3 normalInterpolated = v0.normalWorldOverW * wBary;
+                                 normalInterpolated += v1.normalWorldOverW * uBary;
+                                 normalInterpolated += v2.normalWorldOverW * vBary;
+                                 normalInterpolated *= oneOverInterpolatedOneOverW;
+                    normalInterpolated = SRMath::normalize(normalInterpolated);
+
+                    const MaterialSample surface = sample_material(*material, uv_interpolated);
+                    const SRMath::vec3& base_color = surface.baseColor;
+
+                    if (tangentFrame.valid)
+                    {
+                        // 삼각형 접선을 보간 법선에 Gram-Schmidt로 직교화해 TBN을 만든다.
+                        const SRMath::vec3 tangent = SRMath::normalize(
+                            tangentFrame.tangent - normalInterpolated * SRMath::dot(normalInterpolated, tangentFrame.tangent));
+                        const SRMath::vec3 bitangent = SRMath::cross(normalInterpolated, tangent) * tangentFrame.handedness;
+                        normalInterpolated = SRMath::normalize(tangent * surface.tangentNormal.x
+                            + bitangent * surface.tangentNormal.y + normalInterpolated * surface.tangentNormal.z);
                     }
 
                     // 주변광 조명 계산
@@ -988,10 +1143,10 @@ void Renderer::drawFilledTriangleForTile(const RasterizerVertex& v0, const Raste
 						// 나타내며, 뒷면에서 정반사가 새지 않도록 N·L로 함께 제한한다.
 						const float spec_factor = diffuse_intensity > 0.0f
 							? std::pow(std::max(0.0f, SRMath::dot(viewDir, reflect_dir)),
-								std::max(1.0f, material->shininess))
+								std::max(1.0f, surface.shininess))
 							: 0.0f;
                         
-						SRMath::vec3 specularTerm = material->specular;
+						SRMath::vec3 specularTerm = surface.specular;
 						specularTerm *= spec_factor;
 						specularTerm *= light.color;
 
@@ -1005,23 +1160,33 @@ void Renderer::drawFilledTriangleForTile(const RasterizerVertex& v0, const Raste
                     // 최종 색상의 각 채널(R, G, B)을 0.0과 1.0 사이로 클램핑합니다.
                     color.clamp(0.f, 1.0f);
 
-                    unsigned int final_color = RGB(
-                        color.x * 255.f,
-                        color.y * 255.f,
-                        color.z * 255.f
-                    );
-
-                    // 깊이 갱신 및 픽셀 쓰기
-                    m_depthBuffer[idx] = interpolatedOneOverW;
-                    drawPixel(x, y, final_color);
+                    if (transparency)
+                    {
+                        // 깊이는 쓰지 않고 가중 누적만 한다. 가중치는 가까울수록 크게
+                        // 주어 앞쪽 표면이 평균색을 지배하도록 한다 (논문 식 (9)).
+                        const float viewDepth = oneOverInterpolatedOneOverW;
+                        const float depthScale = viewDepth * (1.0f / 200.0f);
+                        const float weight = opacity * std::clamp(
+                            0.03f / (1e-5f + depthScale * depthScale * depthScale * depthScale), 1e-2f, 3e3f);
+                        const int local = (y - tileMinY) * tile_size + (x - tileMinX);
+                        transparency->accumulation[local] += SRMath::vec4{
+                            color.x * opacity * weight, color.y * opacity * weight, color.z * opacity * weight, opacity * weight };
+                        transparency->revealage[local] *= 1.0f - opacity;
+                    }
+                    else
+                    {
+                        unsigned int final_color = RGB(
+                            color.x * 255.f,
+                            color.y * 255.f,
+                            color.z * 255.f
+                        );
+
+                        // 깊이 갱신 및 픽셀 쓰기
+                        m_depthBuffer[idx] = interpolatedOneOverW;
+                        drawPixel(x, y, final_color);
+                    }
                 }
             }
-
-            // x가 1 증가했으므로, y의 변화량만큼 더해줍니다. (점진적 계산)
-            w0_fixed += dy12_fixed;
-            w1_fixed += dy20_fixed;
-            w2_fixed += dy01_fixed;
-
         }
 
         // y가 1 증가했으므로, 다음 행의 시작 값을 x의 변화량만큼 더해서 갱신합니다.
@@ -1029,6 +1194,7 @@ void Renderer::drawFilledTriangleForTile(const RasterizerVertex& v0, const Raste
         w1Row_fixed -= dx20_fixed;
         w2Row_fixed -= dx01_fixed;
     }
+    return drawn;
 }
 
 // 렌더러 재초기화 (윈도우 크기, 백버퍼/DIB 섹션 생성 등)
@@ -1069,14 +1235,12 @@ bool Renderer::reInit(HWND hWnd)
             auto& myPool = m_threadTrianglePools.local(); // 각 스레드의 삼각형 풀
             auto& myThreadShadedVertex = m_threadShadedVertexBuffers.local();     // 각 스레드마다 타일에 클리프 공간 좌표를 저장
             auto& myThreadStamp = m_threadStamps.local();                         // 각 스레드마다 타일에 스탬프를 저장
-            auto& myThreadNormalMatrixCache = m_threadNormalMatrixCache.local();  // 역행렬 캐시
 
             myPool.reserve(max_triangles_per_thread_pool);
             myThreadShadedVertex.resize(65535); // 충분히 큰 초기 크기 (튜닝 필요)
             myThreadStamp.resize(65'535, std::numeric_limits<std::uint64_t>::max());
 
             // ClipBuffer는 고정 용량이라 TLS 사전 생성이나 reserve가 필요 없다.
-            myThreadNormalMatrixCache.rehash(2000); // 충분히 큰 초기 크기 (튜닝 필요)
             });
         });
 
@@ -1,7 +1,6 @@
 ﻿#pragma once
 #include <vector>
 #include <cstdint>
-#include <unordered_map>
 #include <memory>
 #include <span>
 #include <tbb/enumerable_thread_specific.h>
@@ -79,7 +78,6 @@ private:
 	std::vector<tbb::concurrent_vector<TriangleRef*>> m_finalTriangleBins;
 	tbb::enumerable_thread_specific<tbb::concurrent_vector<TriangleRef>> m_threadTrianglePools; // 실제 TriangleRef 객체들이 저장될 스레드별 메모리 풀
 	tbb::enumerable_thread_specific<ClipBuffer> m_threadClipBuffer1, m_threadClipBuffer2, m_threadClippedVertices;
-	tbb::enumerable_thread_specific<std::unordered_map<const MeshRenderCommand*, SRMath::mat4>>m_threadNormalMatrixCache;
 
 	tbb::enumerable_thread_specific<std::vector<ShadedVertex>> m_threadShadedVertexBuffers; // 클립 공간 좌표를 저장할 버퍼
 	tbb::enumerable_thread_specific<std::vector<std::uint64_t>> m_threadStamps;
@@ -103,9 +101,16 @@ private:
 	void renderTile(int tx, int ty, const tbb::concurrent_vector<TriangleRef*>& triangleBin,
 		const SRMath::vec3& camPos, std::span<const DirectionalLight> lights);
 
+	// transparency가 nullptr이면 불투명 패스(깊이/색 기록), 아니면 반투명 패스로
+	// 타일 OIT 버퍼에 누적만 한다.
 	void resterizationForTile(const ShadedVertex& sv0, const ShadedVertex& sv1, const ShadedVertex& sv2, const Material* material,
-		std::span<const DirectionalLight> lights, const SRMath::vec3& camPos, const MeshRenderCommand& cmd, int tile_minX, int tile_minY, int tile_maxX, int tile_maxY);
-	void drawFilledTriangleForTile(const RasterizerVertex& v0, const RasterizerVertex& v1, const RasterizerVertex& v2, const Material* material, std::span<const DirectionalLight> lights, const SRMath::vec3& camPos, int tile_minX, int tile_minY, int tile_maxX, int tile_maxY);
+		std::span<const DirectionalLight> lights, const SRMath::vec3& camPos, const MeshRenderCommand& cmd, int tile_minX, int tile_minY, int tile_maxX, int tile_maxY,
+		TileTransparencyBuffer* transparency);
+	// 깊이 검사를 통과한 픽셀이 하나라도 있으면 true를 돌려준다.
+	bool drawFilledTriangleForTile(const RasterizerVertex& v0, const RasterizerVertex& v1, const RasterizerVertex& v2, const Material* material,
+		const TangentFrame& tangentFrame, std::span<const DirectionalLight> lights, const SRMath::vec3& camPos, int tile_minX, int tile_minY, int tile_maxX, int tile_maxY,
+		TileTransparencyBuffer* transparency);
+	void resolveTileTransparency(const TileTransparencyBuffer& transparency, int tile_minX, int tile_minY, int tile_maxX, int tile_maxY);
 
 	void drawDebugPrimitive(const DebugPrimitiveCommand& cmd, const SRMath::mat4& vp);
 
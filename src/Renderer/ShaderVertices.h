@@ -24,3 +24,11 @@ struct RasterizerVertex {
     SRMath::vec3 worldPosOverW;     // 원근 보정된 월드 좌표
 
 };
+
+// --- 법선 맵을 위한 삼각형 단위 접선 공간 ---
+// 설명: 위치/UV 변화량으로 구한 월드 접선. 픽셀마다 보간 법선에 직교화해 쓴다.
+struct TangentFrame {
+    SRMath::vec3 tangent;
+    float handedness = 1.0f;        // 비트탄젠트 = cross(N, T) * handedness
+    bool valid = false;             // UV가 퇴화한 삼각형은 법선 맵을 적용하지 않는다
+};
@@ -1,4 +1,5 @@
 ﻿#pragma once
+#include <array>
 #include "Renderer/ShaderVertices.h"
 
 struct MeshRenderCommand;
@@ -18,3 +19,18 @@ struct TriangleRef
 	ShadedVertex sv1;                              // 셰이딩된 버텍스들
     ShadedVertex sv2;                              // 셰이딩된 버텍스들
 };
+
+// 타일 하나의 weighted blended OIT(McGuire & Bavoil 2013) 누적 버퍼.
+// 반투명 조각을 정렬하지 않고 가중 합과 투과율 곱으로만 누적하므로 전역
+// 정렬이 필요 없고, 타일마다 독립적이라 타일 병렬성을 그대로 유지한다.
+struct TileTransparencyBuffer
+{
+    std::array<SRMath::vec4, tile_size * tile_size> accumulation;  // (rgb * a * w, a * w)
+    std::array<float, tile_size * tile_size> revealage;            // Π(1 - a), 1이면 반투명 조각 없음
+
+    void reset() noexcept
+    {
+        accumulation.fill(SRMath::vec4{ 0.0f, 0.0f, 0.0f, 0.0f });
+        revealage.fill(1.0f);
+    }
+};
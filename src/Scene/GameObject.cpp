@@ -1,15 +1,18 @@
 ﻿#include "GameObject.h"
 #include "Graphics/Model.h"
+#include "Graphics/ModelLoadHandle.h"
 #include "Math/Frustum.h"
-#include "Graphics/Octree.h"
+#include "Renderer/OcclusionBuffer.h"
+#include "Graphics/AccelerationStructure.h"
 #include "Utils/DebugUtils.h"
 
+#include <cstdint>
 #include <stdexcept>
 #include <utility>
 #include <tbb/blocked_range.h>
 #include <tbb/parallel_for.h>
 
-GameObject::GameObject(const SRMath::vec3& position, const SRMath::vec3& rotation, const SRMath::vec3& scale, std::unique_ptr<Model> model)
+GameObject::GameObject(const SRMath::vec3& position, const SRMath::vec3& rotation, const SRMath::vec3& scale, std::shared_ptr<const Model> model)
 	: m_position(position),
 	  m_rotation(rotation),
 	  m_scale(scale),
@@ -21,6 +24,18 @@ GameObject::GameObject(const SRMath::vec3& position, const SRMath::vec3& rotatio
 	}
 }
 
+GameObject::GameObject(const SRMath::vec3& position, const SRMath::vec3& rotation, const SRMath::vec3& scale, std::shared_ptr<ModelLoadHandle> pendingModel)
+	: m_position(position),
+	  m_rotation(rotation),
+	  m_scale(scale),
+	  m_pendingModel(std::move(pendingModel))
+{
+	if (!m_pendingModel)
+	{
+		throw std::invalid_argument("GameObject requires a model");
+	}
+}
+
 GameObject::~GameObject() = default;
 
 GameObject::GameObject(GameObject&& move) noexcept = default;
@@ -56,8 +71,25 @@ void GameObject::UpdateTransform(float deltaTime, bool isRotate)
 	else
 		m_normalMatrix = SRMath::mat4::identity();
 
-	const AABB& localAABB = m_model->GetLocalAABB();
-	m_worldAABB = localAABB.Transform(m_worldMatrix);
+	// 핸들은 로드 스레드를 소유하므로 로드가 끝난 뒤에도 GameObject와 함께 유지한다.
+	if (!m_model && m_pendingModel)
+		m_model = m_pendingModel->GetModel();
+
+	// 로드 중에는 모델 AABB가 아직 없으므로 준비된 메시의 AABB를 합친다.
+	AABB localAABB;
+	if (m_model && m_model->IsComplete())
+	{
+		localAABB = m_model->GetLocalAABB();
+	}
+	else if (m_model)
+	{
+		const std::span<const Mesh> meshes = m_model->GetMeshes();
+		for (std::size_t i = 0; i < meshes.size(); ++i)
+		{
+			if (m_model->IsMeshReady(i)) localAABB.Encapsulate(meshes[i].GetLocalAABB());
+		}
+	}
+	m_worldAABB = localAABB.IsValid() ? localAABB.Transform(m_worldMatrix) : AABB{};
 
 }
 
@@ -67,15 +99,35 @@ void GameObject::SetSon(std::shared_ptr<GameObject> son)
 	m_sons.emplace_back(std::move(son));
 }
 
-void GameObject::SubmitToRenderQueue(RenderQueue& renderQueue, const Frustum& frustum, const DebugFlags& debugFlags)
+void GameObject::SetModel(std::shared_ptr<const Model> model)
+{
+	if (!model)
+	{
+		throw std::invalid_argument("GameObject requires a model");
+	}
+	// 이전 모델은 마지막 참조(지난 프레임의 렌더 큐는 이미 비워졌다)와 함께 해제된다.
+	m_model = std::move(model);
+	m_pendingModel.reset();
+	m_visibility.clear(); // 노드 배열이 달라졌다
+}
+
+void GameObject::SubmitToRenderQueue(RenderQueue& renderQueue, const Frustum& frustum, const OcclusionBuffer* occlusion, const DebugFlags& debugFlags)
 {
-	if (!frustum.IsAABBInFrustum(m_worldAABB)) return;
+	if (occlusion && occlusion->TestAABB(m_worldAABB, SRMath::mat4::identity()) == EOcclusionTest::Occluded) return;
 	if (!m_model) return;
 
 	const std::span<const Mesh> meshes = m_model->GetMeshes();
 
 	m_threadLocalCmd.clear();
 	m_threadLocalDebugCmd.clear();
+	// 명령이 기록 위치를 가리키므로 병렬 제출 전에 크기를 정해 둔다.
+	m_visibility.resize(meshes.size());
+
+	// 이 오브젝트의 모든 메시 명령이 공유할 변환을 인스턴스 버퍼에 한 번만 기록한다.
+	const std::uint32_t instanceIndex = renderQueue.AddInstance(RenderInstance{
+		.worldTransform = m_worldMatrix,
+		.normalMatrix = m_normalMatrix
+	});
 
 	tbb::parallel_for(tbb::blocked_range<std::size_t>{ 0, meshes.size() },
 		[&](const tbb::blocked_range<std::size_t>& range) {
@@ -89,18 +141,20 @@ void GameObject::SubmitToRenderQueue(RenderQueue& renderQueue, const Frustum& fr
 
 			for (std::size_t i = range.begin(); i != range.end(); ++i)
 			{
+				if (!m_model->IsMeshReady(i)) continue;
 				const Mesh& mesh = meshes[i];
-				if (mesh.octree)
+				if (mesh.acceleration)
 				{
-					mesh.octree->SubmitNodesToRenderQueue(renderQueue, frustum, m_worldMatrix,
+					mesh.acceleration->SubmitNodesToRenderQueue(frustum, occlusion,
+						occlusion ? &m_visibility[i] : nullptr, m_worldMatrix, instanceIndex,
 						localCmd, localDebugCmd, debugFlags);
 				}
 				else
 				{
 					localCmd.push_back(MeshRenderCommand{
 						.sourceMesh = &mesh,
-						.indicesToDraw = mesh.indices,
-						.worldTransform = m_worldMatrix,
+						.indicesToDraw = mesh.GetIndices(),
+						.instanceIndex = instanceIndex,
 						.material = &mesh.material,
 						.rasterizeMode = debugFlags.bShowWireframe
 							? ERasterizeMode::Wireframe : ERasterizeMode::Fill
@@ -110,11 +164,11 @@ void GameObject::SubmitToRenderQueue(RenderQueue& renderQueue, const Frustum& fr
 				if (debugFlags.bShowNormal)
 				{
 					std::vector<DebugVertex> normalLines;
-					normalLines.reserve(mesh.vertices.size() * 2); // 각 정점마다 시작점과 끝점이 있으므로 2배 크기
+					normalLines.reserve(mesh.GetVertices().size() * 2); // 각 정점마다 시작점과 끝점이 있으므로 2배 크기
 
 					constexpr float normalLength = 0.1f;
 
-					for (const auto& vertex : mesh.vertices)
+					for (const auto& vertex : mesh.GetVertices())
 					{
 						const SRMath::vec3 startPoint_local{ m_worldMatrix * vertex.position };
 
@@ -158,9 +212,9 @@ void GameObject::SubmitToRenderQueue(RenderQueue& renderQueue, const Frustum& fr
 
 	for (const auto& son : m_sons)
 	{
-		if (son)
+		if (son && frustum.IsAABBInFrustum(son->GetWorldAABB()))
 		{
-			son->SubmitToRenderQueue(renderQueue, frustum, debugFlags);
+			son->SubmitToRenderQueue(renderQueue, frustum, occlusion, debugFlags);
 		}
 	}
 }
@@ -6,11 +6,14 @@
 #include "Math/AABB.h"
 #include "Math/SRMath.h"
 #include "Renderer/RenderQueue.h"
+#include "Graphics/AccelerationStructure.h"
 #include <tbb/enumerable_thread_specific.h>
 
 class Model;
+class ModelLoadHandle;
 class RenderQueue;
 class Frustum;
+class OcclusionBuffer;
 struct DebugFlags;
 
 class GameObject
@@ -24,8 +27,12 @@ private:
 	SRMath::mat4 m_normalMatrix; // 법선 행렬 (역전치 행렬)
 
 	// Model
-	std::unique_ptr<Model> m_model;
+	// 비동기 로드 중에는 핸들에서 모델이 나타날 때까지 m_model이 비어 있다.
+	std::shared_ptr<const Model> m_model;
+	std::shared_ptr<ModelLoadHandle> m_pendingModel;
 	AABB m_worldAABB; // 월드 공간에서의 AABB
+	// 메시별 노드 가시성 기록. 모델은 공유되지만 무엇이 보였는지는 인스턴스마다 다르다.
+	std::vector<AccelerationStructure::VisibilityHistory> m_visibility;
 
 	// Hierarchy
 	std::weak_ptr<GameObject> m_parent;
@@ -36,7 +43,12 @@ private:
 
 public:
 
-	GameObject(const SRMath::vec3& position, const SRMath::vec3& rotation, const SRMath::vec3& scale, std::unique_ptr<Model> model);
+	// 모델은 불변 공유 자원이다. 같은 모델을 여러 GameObject에 넘기면 정점/옥트리/재질은
+	// 한 벌만 있고 각 오브젝트는 자기 변환만 가진다.
+	GameObject(const SRMath::vec3& position, const SRMath::vec3& rotation, const SRMath::vec3& scale, std::shared_ptr<const Model> model);
+	// 로드가 끝나기 전에 씬에 넣는다. 준비된 메시부터 그려진다. 같은 핸들을 받은
+	// 오브젝트들은 로드 결과를 공유한다(ModelLoader::AcquireOBJAsync).
+	GameObject(const SRMath::vec3& position, const SRMath::vec3& rotation, const SRMath::vec3& scale, std::shared_ptr<ModelLoadHandle> pendingModel);
 	~GameObject();
 
 	GameObject(GameObject&&) noexcept;
@@ -55,11 +67,22 @@ public:
 	[[nodiscard]] SRMath::vec3 GetScale() const noexcept { return m_scale; }
 	[[nodiscard]] const Model* GetModel() const noexcept { return m_model.get(); }
 	[[nodiscard]] const AABB& GetWorldAABB() const noexcept { return m_worldAABB; }
+	[[nodiscard]] const SRMath::mat4& GetWorldMatrix() const noexcept { return m_worldMatrix; }
 	[[nodiscard]] std::weak_ptr<GameObject> GetParent() const noexcept { return m_parent; }
 	[[nodiscard]] std::span<const std::shared_ptr<GameObject>> GetSons() const noexcept { return m_sons; }
+	// 아직 제출한 적 없는 메시는 nullptr이다.
+	[[nodiscard]] const AccelerationStructure::VisibilityHistory* GetVisibilityHistory(std::size_t meshIndex) const noexcept
+	{
+		return meshIndex < m_visibility.size() ? &m_visibility[meshIndex] : nullptr;
+	}
 
 	void SetSon(std::shared_ptr<GameObject> son);
+	// 핫 리로드가 다시 읽은 모델로 바꾼다. 렌더 큐를 다시 채우기 전(프레임 사이)에만 호출한다.
+	void SetModel(std::shared_ptr<const Model> model);
 
 	// Rendering
-	void SubmitToRenderQueue(RenderQueue& renderQueue, const Frustum& frustum, const DebugFlags& debugFlags);
+	// 호출자가 이 오브젝트의 월드 AABB를 이미 절두체로 걸렀다고 본다(최상위는 SceneBvh, 자식은 부모가 검사한다).
+	// occlusion이 nullptr이면 오클루전 컬링 없이 절두체 컬링만 한다. 오클루전 컬링 중에는
+	// 렌더러가 채울 노드 가시성 기록을 명령에 연결한다.
+	void SubmitToRenderQueue(RenderQueue& renderQueue, const Frustum& frustum, const OcclusionBuffer* occlusion, const DebugFlags& debugFlags);
 };
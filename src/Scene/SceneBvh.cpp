@@ -0,0 +1,277 @@
+﻿#include "SceneBvh.h"
+#include <algorithm>
+#include <limits>
+#include <utility>
+#include "Math/Frustum.h"
+#include "Math/SIMD.h"
+
+namespace
+{
+	// vec3의 operator==는 네 번째 성분까지 비교하므로 경계 비교는 성분별로 한다.
+	[[nodiscard]] bool same_bounds(const AABB& lhs, const AABB& rhs) noexcept
+	{
+		return lhs.min.x == rhs.min.x && lhs.min.y == rhs.min.y && lhs.min.z == rhs.min.z
+			&& lhs.max.x == rhs.max.x && lhs.max.y == rhs.max.y && lhs.max.z == rhs.max.z;
+	}
+
+	// 반직선이 상자에 들어가는 거리(출발점이 안쪽이면 0)를 entry에 쓰고 지나는지 돌려준다.
+	// 축에 평행한 방향은 역수가 무한대가 되어 그 축의 슬랩 안에 있을 때만 통과한다.
+	[[nodiscard]] bool ray_enters(const AABB& box, const SRMath::vec3& origin, const SRMath::vec3& inverseDirection, float& entry) noexcept
+	{
+		float entryDistance = 0.f;
+		float exitDistance = std::numeric_limits<float>::max();
+		for (std::size_t axis = 0; axis < 3; ++axis)
+		{
+			const float t0 = (box.min[axis] - origin[axis]) * inverseDirection[axis];
+			const float t1 = (box.max[axis] - origin[axis]) * inverseDirection[axis];
+			entryDistance = std::max(entryDistance, std::min(t0, t1));
+			exitDistance = std::min(exitDistance, std::max(t0, t1));
+		}
+		entry = entryDistance;
+		return entryDistance <= exitDistance;
+	}
+}
+
+void SceneBvh::Build(std::span<const AABB> bounds)
+{
+	static_assert(max_leaf_objects <= SRMath::SIMD::AABBx8::lane_count);
+
+	m_objectBounds.assign(bounds.begin(), bounds.end());
+	rebuild();
+}
+
+void SceneBvh::rebuild()
+{
+	const auto objectCount = static_cast<std::uint32_t>(m_objectBounds.size());
+	const std::span<const AABB> bounds = m_objectBounds;
+	m_nodes.clear();
+	m_dirtyLeaves.clear();
+	m_rebuildPending = false;
+	m_objectLeaf.assign(objectCount, 0);
+	m_objects.resize(objectCount);
+	for (std::uint32_t i = 0; i < objectCount; ++i) m_objects[i] = i;
+	if (objectCount == 0) return;
+
+	// 빈 상자는 어느 쪽으로 가든 질의에 나오지 않으므로 중심을 원점으로 둔다.
+	std::vector<SRMath::vec3> centroids(objectCount);
+	for (std::uint32_t i = 0; i < objectCount; ++i)
+		centroids[i] = bounds[i].IsValid() ? bounds[i].Center() : SRMath::vec3{ 0.f, 0.f, 0.f };
+
+	m_nodes.reserve(objectCount); // 리프에는 오브젝트가 둘 이상 있으므로 노드는 오브젝트 수보다 적다
+	m_nodes.emplace_back();
+	buildNode(0, 0, objectCount, centroids);
+}
+
+// 중심 경계가 가장 긴 축의 중앙값에서 둘로 나눈다. 오브젝트 수가 반씩 갈리므로 깊이는 log N이고,
+// 자식을 만든 뒤에 재귀하므로 자식은 항상 부모보다 뒤에 놓인다(Refit의 역순 훑기가 이에 기댄다).
+void SceneBvh::buildNode(std::uint32_t nodeIndex, std::uint32_t begin, std::uint32_t end, std::vector<SRMath::vec3>& centroids)
+{
+	m_nodes[nodeIndex].objectBegin = begin;
+	m_nodes[nodeIndex].objectCount = end - begin;
+	if (end - begin <= max_leaf_objects)
+	{
+		for (std::uint32_t i = begin; i < end; ++i) m_objectLeaf[m_objects[i]] = nodeIndex;
+		refitNode(m_nodes[nodeIndex]);
+		return;
+	}
+
+	AABB centroidBounds;
+	for (std::uint32_t i = begin; i < end; ++i) centroidBounds.Encapsulate(centroids[m_objects[i]]);
+	const SRMath::vec3 extent = centroidBounds.max - centroidBounds.min;
+	const std::size_t axis = extent.x >= extent.y && extent.x >= extent.z ? 0 : extent.y >= extent.z ? 1 : 2;
+
+	const std::uint32_t mid = begin + (end - begin) / 2;
+	std::nth_element(m_objects.begin() + begin, m_objects.begin() + mid, m_objects.begin() + end,
+		[&centroids, axis](std::uint32_t lhs, std::uint32_t rhs) { return centroids[lhs][axis] < centroids[rhs][axis]; });
+
+	// emplace_back이 배열을 옮길 수 있으므로 노드는 번호로만 가리킨다.
+	const auto firstChild = static_cast<std::uint32_t>(m_nodes.size());
+	m_nodes[nodeIndex].firstChild = firstChild;
+	m_nodes.emplace_back().parent = nodeIndex;
+	m_nodes.emplace_back().parent = nodeIndex;
+	buildNode(firstChild, begin, mid, centroids);
+	buildNode(firstChild + 1, mid, end, centroids);
+	refitNode(m_nodes[nodeIndex]);
+}
+
+bool SceneBvh::refitNode(Node& node) noexcept
+{
+	AABB bounds;
+	if (node.firstChild == 0)
+	{
+		for (std::uint32_t i = node.objectBegin; i < node.objectBegin + node.objectCount; ++i)
+			bounds.Encapsulate(m_objectBounds[m_objects[i]]);
+	}
+	else
+	{
+		bounds = m_nodes[node.firstChild].bounds;
+		bounds.Encapsulate(m_nodes[node.firstChild + 1].bounds);
+	}
+
+	if (same_bounds(bounds, node.bounds)) return false;
+	node.bounds = bounds;
+	return true;
+}
+
+void SceneBvh::SetBounds(std::size_t object, const AABB& bounds)
+{
+	if (object >= m_objectBounds.size() || same_bounds(m_objectBounds[object], bounds)) return;
+	if (m_objectBounds[object].IsValid() != bounds.IsValid()) m_rebuildPending = true;
+	m_objectBounds[object] = bounds;
+	m_dirtyLeaves.push_back(m_objectLeaf[object]);
+}
+
+void SceneBvh::Refit()
+{
+	if (m_rebuildPending)
+	{
+		rebuild();
+		return;
+	}
+	if (m_dirtyLeaves.empty()) return;
+
+	// 리프마다 루트 쪽으로 올라가되 경계가 그대로인 조상에서 멈춘다. 조상은 항상 자식의 현재
+	// 경계로 다시 구하므로 같은 조상을 여러 번 지나도 결과는 같다. 리프 대부분이 바뀐 프레임
+	// (예: 모든 오브젝트가 회전)에는 올라가는 경로가 겹치므로 전체를 역순으로 한 번 훑는 편이 싸다.
+	if (m_dirtyLeaves.size() * 16 > m_nodes.size())
+	{
+		for (std::size_t i = m_nodes.size(); i-- > 0;) refitNode(m_nodes[i]);
+	}
+	else
+	{
+		for (std::uint32_t index : m_dirtyLeaves)
+		{
+			while (refitNode(m_nodes[index]) && index != 0) index = m_nodes[index].parent;
+		}
+	}
+	m_dirtyLeaves.clear();
+}
+
+// 노드의 두 자식을 한 배치로 검사하고, 리프에서는 담긴 오브젝트들을 한 배치로 검사한다.
+// 부모가 완전히 안쪽인 평면은 자식 검사에서 빼며, 모든 평면 안쪽이면 검사를 멈춘다.
+void SceneBvh::QueryFrustum(const Frustum& frustum, std::vector<std::size_t>& visible) const
+{
+	if (m_nodes.empty()) return;
+
+	struct VisibleNode
+	{
+		std::uint32_t index;
+		std::uint32_t crossedPlanes;
+	};
+
+	SRMath::SIMD::AABBx8 rootBatch;
+	rootBatch.Set(0, m_nodes[0].bounds.min, m_nodes[0].bounds.max);
+	const SRMath::SIMD::PlaneTestMask rootMask = frustum.TestAABBs(rootBatch);
+	if ((rootMask.visible & 1u) == 0) return;
+
+	thread_local std::vector<VisibleNode> stack;
+	stack.clear();
+	stack.push_back({ 0, rootMask.CrossedPlanes(0) & Frustum::all_planes });
+	while (!stack.empty())
+	{
+		const VisibleNode current = stack.back();
+		stack.pop_back();
+		const Node& node = m_nodes[current.index];
+
+		if (current.crossedPlanes == 0)
+		{
+			// 경계는 담긴 오브젝트를 모두 감싸므로 빈 상자만 빼고 그대로 넣는다.
+			for (std::uint32_t i = node.objectBegin; i < node.objectBegin + node.objectCount; ++i)
+			{
+				if (m_objectBounds[m_objects[i]].IsValid()) visible.push_back(m_objects[i]);
+			}
+			continue;
+		}
+
+		if (node.firstChild == 0)
+		{
+			SRMath::SIMD::AABBx8 objects;
+			for (std::uint32_t lane = 0; lane < node.objectCount; ++lane)
+			{
+				const AABB& bounds = m_objectBounds[m_objects[node.objectBegin + lane]];
+				objects.Set(lane, bounds.min, bounds.max);
+			}
+			const SRMath::SIMD::PlaneTestMask mask = frustum.TestAABBs(objects, current.crossedPlanes);
+			for (std::uint32_t lane = 0; lane < node.objectCount; ++lane)
+			{
+				if (((mask.visible >> lane) & 1u) != 0) visible.push_back(m_objects[node.objectBegin + lane]);
+			}
+			continue;
+		}
+
+		SRMath::SIMD::AABBx8 children;
+		for (std::uint32_t child = 0; child < 2; ++child)
+		{
+			const AABB& bounds = m_nodes[node.firstChild + child].bounds;
+			children.Set(child, bounds.min, bounds.max);
+		}
+		const SRMath::SIMD::PlaneTestMask mask = frustum.TestAABBs(children, current.crossedPlanes);
+		for (std::uint32_t child = 2; child-- > 0;)
+		{
+			if (((mask.visible >> child) & 1u) == 0) continue;
+			stack.push_back({ node.firstChild + child, mask.CrossedPlanes(child) & current.crossedPlanes });
+		}
+	}
+}
+
+void SceneBvh::QueryAABB(const AABB& box, std::vector<std::size_t>& overlapping) const
+{
+	if (m_nodes.empty() || !box.IsValid()) return;
+
+	thread_local std::vector<std::uint32_t> stack;
+	stack.clear();
+	stack.push_back(0);
+	while (!stack.empty())
+	{
+		const Node& node = m_nodes[stack.back()];
+		stack.pop_back();
+		if (!node.bounds.Intersects(box)) continue;
+
+		if (node.firstChild == 0)
+		{
+			for (std::uint32_t i = node.objectBegin; i < node.objectBegin + node.objectCount; ++i)
+			{
+				if (m_objectBounds[m_objects[i]].Intersects(box)) overlapping.push_back(m_objects[i]);
+			}
+			continue;
+		}
+		stack.push_back(node.firstChild + 1);
+		stack.push_back(node.firstChild);
+	}
+}
+
+void SceneBvh::QueryRay(const SRMath::vec3& origin, const SRMath::vec3& direction, std::vector<std::size_t>& hits) const
+{
+	if (m_nodes.empty()) return;
+
+	const SRMath::vec3 inverseDirection{ 1.f / direction.x, 1.f / direction.y, 1.f / direction.z };
+	std::vector<std::pair<float, std::uint32_t>> entries;
+
+	thread_local std::vector<std::uint32_t> stack;
+	stack.clear();
+	stack.push_back(0);
+	while (!stack.empty())
+	{
+		const Node& node = m_nodes[stack.back()];
+		stack.pop_back();
+		// 빈 상자는 min > max라서 슬랩 검사로는 걸러지지 않는다.
+		float entry = 0.f;
+		if (!node.bounds.IsValid() || !ray_enters(node.bounds, origin, inverseDirection, entry)) continue;
+
+		if (node.firstChild == 0)
+		{
+			for (std::uint32_t i = node.objectBegin; i < node.objectBegin + node.objectCount; ++i)
+			{
+				const AABB& bounds = m_objectBounds[m_objects[i]];
+				if (bounds.IsValid() && ray_enters(bounds, origin, inverseDirection, entry))
+					entries.emplace_back(entry, m_objects[i]);
+			}
+			continue;
+		}
+		stack.push_back(node.firstChild + 1);
+		stack.push_back(node.firstChild);
+	}
+
+	std::ranges::sort(entries);
+	for (const auto& [entry, object] : entries) hits.push_back(object);
+}
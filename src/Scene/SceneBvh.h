@@ -0,0 +1,66 @@
+﻿#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+#include "Math/SRMath.h"
+#include "Math/AABB.h"
+
+class Frustum;
+
+// 최상위 GameObject들의 월드 AABB 위에 놓인 동적 이진 BVH. 오브젝트가 추가되거나 빠지면
+// Build로 다시 만들고, 움직인 오브젝트는 SetBounds 뒤 Refit으로 리프에서 루트 쪽 경계만 다시 맞춘다.
+// 질의 비용은 전체 오브젝트 수가 아니라 결과에 닿는 노드 수에 비례한다.
+//
+// Refit은 트리 모양을 바꾸지 않으므로 오브젝트가 처음 배치에서 멀리 흩어지면 형제 경계가 겹쳐
+// 질의가 느려진다. 그때는 Build를 다시 부른다.
+class SceneBvh
+{
+private:
+	// 자식은 항상 두 개이고 firstChild, firstChild + 1에 놓이며 부모보다 뒤에 있다.
+	// 노드가 덮는 오브젝트는 m_objects의 [objectBegin, objectBegin + objectCount)로 이어져 있다.
+	struct Node
+	{
+		AABB bounds;
+		std::uint32_t objectBegin = 0;
+		std::uint32_t objectCount = 0;
+		std::uint32_t firstChild = 0;	// 0이면 리프(루트는 누구의 자식도 아니다)
+		std::uint32_t parent = 0;
+	};
+
+	std::vector<Node> m_nodes;
+	std::vector<std::uint32_t> m_objects;	// 리프 순서로 늘어놓은 오브젝트 번호
+	std::vector<std::uint32_t> m_objectLeaf;	// 오브젝트 번호 -> 담긴 리프
+	std::vector<AABB> m_objectBounds;	// 오브젝트 번호 -> 월드 AABB
+	std::vector<std::uint32_t> m_dirtyLeaves;	// SetBounds 이후 Refit을 기다리는 리프
+	// 경계가 비어 있다가 생긴(로드가 끝난) 오브젝트는 빌드 때 자리가 없었으므로 Refit이 다시 빌드한다.
+	bool m_rebuildPending = false;
+
+	void rebuild();
+	void buildNode(std::uint32_t nodeIndex, std::uint32_t begin, std::uint32_t end, std::vector<SRMath::vec3>& centroids);
+	// 노드 경계를 자식(리프는 오브젝트)에서 다시 구하고 바뀌었는지 돌려준다.
+	bool refitNode(Node& node) noexcept;
+
+	// 리프에 담는 최대 오브젝트 수. 리프의 오브젝트는 한 번의 SIMD 배치로 검사한다.
+	static constexpr std::uint32_t max_leaf_objects = 4;
+
+public:
+	// bounds[i]가 오브젝트 i의 경계다. 빈 상자(IsValid() == false)는 어떤 질의에도 나오지 않는다.
+	void Build(std::span<const AABB> bounds);
+	// 오브젝트 하나의 경계를 바꾼다. 조상 노드는 Refit을 부를 때까지 이전 경계를 유지한다.
+	void SetBounds(std::size_t object, const AABB& bounds);
+	// SetBounds로 바뀐 리프의 조상 경계를 다시 맞춘다. 바뀐 리프가 많으면 모든 노드를 한 번 훑고,
+	// 빈 상자였던 오브젝트가 경계를 얻었거나 그 반대이면 트리를 다시 빌드한다.
+	void Refit();
+
+	[[nodiscard]] std::size_t GetObjectCount() const noexcept { return m_objectBounds.size(); }
+
+	// 절두체와 겹치는 오브젝트 번호를 visible에 덧붙인다. 모든 평면 안쪽인 하위 트리는 더 검사하지
+	// 않고 통째로 넣는다.
+	void QueryFrustum(const Frustum& frustum, std::vector<std::size_t>& visible) const;
+	// box와 겹치는 오브젝트 번호를 overlapping에 덧붙인다.
+	void QueryAABB(const AABB& box, std::vector<std::size_t>& overlapping) const;
+	// origin에서 direction으로 뻗은 반직선이 경계를 지나는 오브젝트 번호를 가까운 순서로 덧붙인다.
+	// 피킹은 이 순서대로 메시를 정밀 검사하다가 처음 맞는 것에서 멈추면 된다.
+	void QueryRay(const SRMath::vec3& origin, const SRMath::vec3& direction, std::vector<std::size_t>& hits) const;
+};
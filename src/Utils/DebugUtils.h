@@ -24,4 +24,5 @@ struct DebugFlags
 	bool bShowAABB = false;   // AABB 표시 여부
 	bool bShowWireframe = false; // 와이어프레임 표시 여부
 	bool bShowLightDirection = false; // 방향광 진행/셰이딩 방향 표시 여부
+	bool bOcclusionCulling = true; // 오클루전 버퍼로 가려진 오브젝트/노드 컬링 여부
 };
@@ -22,8 +22,13 @@
     }
 }
 
-[[nodiscard]] inline std::filesystem::path MakeAssetPath(std::string_view nameWithExt)
+[[nodiscard]] inline const std::filesystem::path& GetAssetDirectory()
 {
     static const std::filesystem::path base = GetExecutableDirectory() / L"assets";
-    return base / std::filesystem::path(nameWithExt);
+    return base;
+}
+
+[[nodiscard]] inline std::filesystem::path MakeAssetPath(std::string_view nameWithExt)
+{
+    return GetAssetDirectory() / std::filesystem::path(nameWithExt);
 }
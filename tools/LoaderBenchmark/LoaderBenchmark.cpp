@@ -0,0 +1,275 @@
+﻿// 헤드리스 OBJ 로더 벤치마크.
+//
+//   LoaderBenchmark [--corpus <dir>] [--scale <s>] [--runs <n>] [--keep]
+//                   [--accel octree|bvh] [--leaf <n>] [--loose <k>]
+//                   [--texture-format rgba8|rgba32f|rgba16f|bc1] [file.obj ...]
+//
+// 파일을 주지 않으면 합성 코퍼스를 만들어 측정한다. .srmesh 캐시는 항상 우회하며
+// 첫 로드는 페이지 캐시를 데우는 용도로 버린다. 처리량은 실행 시간의 중앙값 기준이다.
+// --texture-format은 코퍼스 재질의 텍스처 포맷을 정하고, 로드한 diffuse 텍스처의
+// 표본 처리량을 함께 출력한다.
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <filesystem>
+#include <print>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+#include "Platform/Win32Headers.h"
+#include <psapi.h>
+
+#include "Graphics/AccelerationStructure.h"
+#include "Graphics/Mesh.h"
+#include "Graphics/Model.h"
+#include "Graphics/ModelLoader.h"
+#include "Graphics/Texture.h"
+#include "ObjCorpusGenerator.h"
+
+namespace
+{
+	struct BenchmarkOptions
+	{
+		std::filesystem::path corpusDirectory = std::filesystem::temp_directory_path() / "sr_loader_corpus";
+		double scale = 1.0;
+		int runs = 5;
+		bool keepCorpus = false;
+		AccelerationSettings acceleration;
+		ETextureFormat textureFormat = ETextureFormat::RGBA8;
+		std::vector<CorpusFile> files;
+	};
+
+	struct PhaseTotals
+	{
+		double parse = 0.0;
+		double dedup = 0.0;
+		double materials = 0.0;
+		double normals = 0.0;
+		double aabb = 0.0;
+		double acceleration = 0.0;
+	};
+
+	[[nodiscard]] double to_ms(std::int64_t nanoseconds) noexcept
+	{
+		return static_cast<double>(nanoseconds) * 1e-6;
+	}
+
+	// 프로세스 수명 동안의 최대 작업 집합. 되돌릴 수 없으므로 파일마다 누적 최댓값이 된다.
+	[[nodiscard]] double peak_working_set_mb()
+	{
+		PROCESS_MEMORY_COUNTERS counters{};
+		counters.cb = sizeof(counters);
+		if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+			return 0.0;
+		return static_cast<double>(counters.PeakWorkingSetSize) / (1024.0 * 1024.0);
+	}
+
+	[[nodiscard]] bool parse_arguments(int argc, char** argv, BenchmarkOptions& options)
+	{
+		for (int i = 1; i < argc; ++i)
+		{
+			const std::string_view argument = argv[i];
+			const bool hasValue = i + 1 < argc;
+			if (argument == "--corpus" && hasValue)
+				options.corpusDirectory = argv[++i];
+			else if (argument == "--scale" && hasValue)
+				options.scale = std::atof(argv[++i]);
+			else if (argument == "--runs" && hasValue)
+				options.runs = std::max(1, std::atoi(argv[++i]));
+			else if (argument == "--keep")
+				options.keepCorpus = true;
+			else if (argument == "--accel" && hasValue)
+			{
+				const std::string_view type = argv[++i];
+				if (type == "octree")
+					options.acceleration.type = EAccelerationStructure::Octree;
+				else if (type == "bvh")
+					options.acceleration.type = EAccelerationStructure::Bvh;
+				else
+					return false;
+			}
+			else if (argument == "--leaf" && hasValue)
+				options.acceleration.maxLeafTriangles = static_cast<std::uint32_t>(std::max(1, std::atoi(argv[++i])));
+			else if (argument == "--loose" && hasValue)
+				options.acceleration.octreeLooseness = std::max(1.f, static_cast<float>(std::atof(argv[++i])));
+			else if (argument == "--texture-format" && hasValue)
+			{
+				const auto format = ParseTextureFormat(argv[++i]);
+				if (!format)
+					return false;
+				options.textureFormat = *format;
+			}
+			else if (argument.starts_with("--"))
+				return false;
+			else
+				options.files.push_back(CorpusFile{ std::filesystem::path(argument).stem().string(), "user file", argument });
+		}
+		return true;
+	}
+
+	struct TextureSampleResult
+	{
+		std::size_t textureCount = 0;
+		std::string formats;				// 실제 내부 포맷 (RGBA16F는 F16C가 없으면 RGBA32F가 된다)
+		double samplesPerSecond = 0.0;
+		SRMath::Color4 mean{};				// 포맷 간 양자화 오차 비교용. 표본 루프가 제거되지 않게도 한다
+	};
+
+	// 모델이 쓰는 diffuse 텍스처를 격자로 표본해 실제 내부 포맷과 표본 처리량을 잰다.
+	// 반복 랩 모드가 [0, 1] 밖도 읽도록 UV 범위를 두 주기로 잡는다.
+	[[nodiscard]] TextureSampleResult benchmark_textures(const Model& model)
+	{
+		std::unordered_set<const Texture*> textures;
+		for (const Mesh& mesh : model.GetMeshes())
+		{
+			if (mesh.material.diffuseTexture)
+				textures.insert(mesh.material.diffuseTexture.get());
+		}
+		TextureSampleResult result;
+		result.textureCount = textures.size();
+		if (textures.empty())
+			return result;
+
+		constexpr int grid = 1024;
+		constexpr float step = 2.0f / grid;
+		SRMath::Color4 sum{};
+		const auto start = std::chrono::steady_clock::now();
+		for (const Texture* texture : textures)
+		{
+			for (int y = 0; y < grid; ++y)
+			{
+				for (int x = 0; x < grid; ++x)
+					sum += texture->SampleRGBA(static_cast<float>(x) * step - 0.5f, static_cast<float>(y) * step - 0.5f);
+			}
+		}
+		const auto end = std::chrono::steady_clock::now();
+		for (const Texture* texture : textures)
+		{
+			if (!result.formats.empty()) result.formats += ',';
+			result.formats += TextureFormatName(texture->GetFormat());
+		}
+
+		const double samples = static_cast<double>(textures.size()) * grid * grid;
+		result.samplesPerSecond = samples / std::chrono::duration<double>(end - start).count();
+		result.mean = sum * (1.0f / static_cast<float>(samples));
+		return result;
+	}
+
+	// 한 파일을 runs번 로드하고 결과 한 줄과 단계별 평균을 출력한다.
+	[[nodiscard]] bool benchmark_file(const CorpusFile& file, int runs, const AccelerationSettings& acceleration)
+	{
+		const ModelLoadOptions warmUp{ .useCache = false, .acceleration = acceleration };
+		auto model = ModelLoader::LoadOBJ(file.path, warmUp);
+		if (!model)
+		{
+			std::println("{:<12} FAILED: {} (line {})", file.name, model.error().message, model.error().line);
+			return false;
+		}
+
+		std::size_t vertexCount = 0;
+		std::size_t triangleCount = 0;
+		std::size_t nodeCount = 0;
+		std::size_t interiorTriangles = 0;	// 자식이 있는 노드에 남은 삼각형: 그 노드가 보이면 항상 제출된다
+		for (const Mesh& mesh : (*model)->GetMeshes())
+		{
+			vertexCount += mesh.GetVertices().size();
+			triangleCount += mesh.GetIndices().size() / 3;
+			if (!mesh.acceleration) continue;
+			nodeCount += mesh.acceleration->GetNodes().size();
+			for (const auto& node : mesh.acceleration->GetNodes())
+			{
+				if (node.childCount != 0) interiorTriangles += node.indexCount / 3;
+			}
+		}
+		const std::size_t meshCount = (*model)->GetMeshes().size();
+		const TextureSampleResult textures = benchmark_textures(**model);
+		model->reset();
+
+		std::vector<double> wallMs;
+		PhaseTotals phases;
+		for (int run = 0; run < runs; ++run)
+		{
+			ModelLoadProfile profile;
+			const ModelLoadOptions options{ .useCache = false, .profile = &profile, .acceleration = acceleration };
+			const auto start = std::chrono::steady_clock::now();
+			auto measured = ModelLoader::LoadOBJ(file.path, options);
+			const auto end = std::chrono::steady_clock::now();
+			if (!measured)
+				return false;
+			// 해제 비용은 로드 시간에 넣지 않는다.
+			measured->reset();
+
+			wallMs.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+			phases.parse += to_ms(profile.parseNs.load());
+			phases.dedup += to_ms(profile.dedupNs.load());
+			phases.materials += to_ms(profile.materialsNs.load());
+			phases.normals += to_ms(profile.normalsNs.load());
+			phases.aabb += to_ms(profile.aabbNs.load());
+			phases.acceleration += to_ms(profile.accelerationNs.load());
+		}
+
+		std::ranges::sort(wallMs);
+		const double medianMs = wallMs[wallMs.size() / 2];
+		const double seconds = medianMs * 1e-3;
+		const double fileMb = static_cast<double>(std::filesystem::file_size(file.path)) / (1024.0 * 1024.0);
+		const double scale = 1.0 / static_cast<double>(runs);
+
+		std::println("{:<12} {:>8.1f} {:>9.1f} {:>8.1f} {:>9.2f} {:>10} {:>10} {:>7} {:>9.1f}",
+			file.name, fileMb, medianMs, fileMb / seconds, static_cast<double>(vertexCount) / seconds * 1e-6,
+			vertexCount, triangleCount, meshCount, peak_working_set_mb());
+		std::println("{:<12} parse {:.1f} | dedup {:.1f} | mtl {:.1f} | normals {:.1f} | aabb {:.1f} | accel {:.1f} ms ({} nodes, {} interior tris)",
+			"", phases.parse * scale, phases.dedup * scale, phases.materials * scale, phases.normals * scale, phases.aabb * scale, phases.acceleration * scale,
+			nodeCount, interiorTriangles);
+		if (textures.textureCount != 0)
+			std::println("{:<12} textures {} ({}) | sample {:.1f} M/s | mean rgb {:.3f} {:.3f} {:.3f}",
+				"", textures.textureCount, textures.formats, textures.samplesPerSecond * 1e-6,
+				textures.mean.r, textures.mean.g, textures.mean.b);
+		return true;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	BenchmarkOptions options;
+	if (!parse_arguments(argc, argv, options))
+	{
+		std::println(stderr, "usage: LoaderBenchmark [--corpus <dir>] [--scale <s>] [--runs <n>] [--keep] [--accel octree|bvh] [--leaf <n>] [--loose <k>] [--texture-format rgba8|rgba32f|rgba16f|bc1] [file.obj ...]");
+		return 2;
+	}
+
+	const bool generated = options.files.empty();
+	try
+	{
+		if (generated)
+		{
+			std::println("generating corpus in {} (scale {})", options.corpusDirectory.string(), options.scale);
+			options.files = GenerateObjCorpus(options.corpusDirectory, options.scale, options.textureFormat);
+			for (const CorpusFile& file : options.files)
+				std::println("  {:<12} {}", file.name, file.description);
+		}
+	}
+	catch (const std::exception& error)
+	{
+		std::println(stderr, "{}", error.what());
+		return 1;
+	}
+
+	// 법선/AABB/옥트리는 메시 단위로 병렬 실행되므로 작업 스레드 시간의 합이다.
+	std::println("{:<12} {:>8} {:>9} {:>8} {:>9} {:>10} {:>10} {:>7} {:>9}",
+		"file", "MB", "median ms", "MB/s", "Mverts/s", "vertices", "triangles", "meshes", "peak MB");
+
+	bool succeeded = true;
+	for (const CorpusFile& file : options.files)
+		succeeded = benchmark_file(file, options.runs, options.acceleration) && succeeded;
+
+	if (generated && !options.keepCorpus)
+	{
+		std::error_code ignored;
+		std::filesystem::remove_all(options.corpusDirectory, ignored);
+	}
+	return succeeded ? 0 : 1;
+}
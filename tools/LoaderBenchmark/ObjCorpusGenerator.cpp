@@ -0,0 +1,313 @@
+﻿#include "ObjCorpusGenerator.h"
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstddef>
+#include <fstream>
+#include <stdexcept>
+#include <string_view>
+
+namespace
+{
+	// 격자 하나의 배치와 포함할 속성. 곡면 높이를 주어 법선이 모두 같지 않게 한다.
+	struct GridOptions
+	{
+		std::size_t resolution = 0;	// 한 변의 사각형 수
+		float originX = 0.0f;
+		float originY = 0.0f;
+		float size = 1.0f;
+		bool texcoords = true;
+		bool normals = true;
+		bool quads = false;
+	};
+
+	// 문자열 버퍼에 OBJ 텍스트를 쌓고 일정 크기마다 파일로 흘려보낸다.
+	// 정수/실수 서식은 to_chars로 처리해 생성 시간이 측정 대상보다 커지지 않게 한다.
+	class ObjWriter
+	{
+	private:
+		static constexpr std::size_t flush_threshold = 8u << 20;
+
+		std::ofstream m_stream;
+		std::string m_text;
+		std::size_t m_positionCount = 0;
+		std::size_t m_texcoordCount = 0;
+		std::size_t m_normalCount = 0;
+
+		void flushIfLarge()
+		{
+			if (m_text.size() >= flush_threshold)
+				Flush();
+		}
+
+		void append(float value)
+		{
+			char buffer[32];
+			const auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+			m_text.append(buffer, result.ptr);
+		}
+
+		void append(std::size_t value)
+		{
+			char buffer[24];
+			const auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+			m_text.append(buffer, result.ptr);
+		}
+
+		void corner(std::size_t position, std::size_t texcoord, std::size_t normal, const GridOptions& options)
+		{
+			m_text += ' ';
+			append(position);
+			if (!options.texcoords && !options.normals)
+				return;
+			m_text += '/';
+			if (options.texcoords)
+				append(texcoord);
+			if (options.normals)
+			{
+				m_text += '/';
+				append(normal);
+			}
+		}
+
+	public:
+		explicit ObjWriter(const std::filesystem::path& path)
+			: m_stream(path, std::ios::binary | std::ios::trunc)
+		{
+			if (!m_stream)
+				throw std::runtime_error("Unable to create corpus file: " + path.string());
+			m_text.reserve(flush_threshold + (64u << 10));
+		}
+
+		~ObjWriter() { Flush(); }
+		ObjWriter(const ObjWriter&) = delete;
+		ObjWriter& operator=(const ObjWriter&) = delete;
+
+		void Line(std::string_view text)
+		{
+			m_text.append(text);
+			m_text += '\n';
+		}
+
+		// (resolution + 1)^2 정점의 물결 곡면 격자를 쓰고 면은 현재 그룹에 붙인다.
+		void Grid(const GridOptions& options)
+		{
+			const std::size_t side = options.resolution + 1;
+			const float step = options.size / static_cast<float>(options.resolution);
+			const std::size_t positionBase = m_positionCount + 1;
+			const std::size_t texcoordBase = m_texcoordCount + 1;
+			const std::size_t normalBase = m_normalCount + 1;
+
+			for (std::size_t y = 0; y < side; ++y)
+			{
+				for (std::size_t x = 0; x < side; ++x)
+				{
+					const float px = options.originX + step * static_cast<float>(x);
+					const float py = options.originY + step * static_cast<float>(y);
+					const float height = 0.1f * std::sin(px * 3.0f) * std::cos(py * 3.0f);
+					m_text += "v ";
+					append(px);
+					m_text += ' ';
+					append(height);
+					m_text += ' ';
+					append(py);
+					m_text += '\n';
+					if (options.texcoords)
+					{
+						m_text += "vt ";
+						append(static_cast<float>(x) / static_cast<float>(options.resolution));
+						m_text += ' ';
+						append(static_cast<float>(y) / static_cast<float>(options.resolution));
+						m_text += '\n';
+					}
+					if (options.normals)
+					{
+						// 높이 함수의 기울기로 만든 해석적 법선
+						const float dx = -0.3f * std::cos(px * 3.0f) * std::cos(py * 3.0f);
+						const float dz = 0.3f * std::sin(px * 3.0f) * std::sin(py * 3.0f);
+						const float inverseLength = 1.0f / std::sqrt(dx * dx + 1.0f + dz * dz);
+						m_text += "vn ";
+						append(dx * inverseLength);
+						m_text += ' ';
+						append(inverseLength);
+						m_text += ' ';
+						append(dz * inverseLength);
+						m_text += '\n';
+					}
+					flushIfLarge();
+				}
+			}
+			m_positionCount += side * side;
+			if (options.texcoords) m_texcoordCount += side * side;
+			if (options.normals) m_normalCount += side * side;
+
+			for (std::size_t y = 0; y < options.resolution; ++y)
+			{
+				for (std::size_t x = 0; x < options.resolution; ++x)
+				{
+					const std::size_t a = y * side + x;
+					const std::size_t b = a + 1;
+					const std::size_t c = a + side + 1;
+					const std::size_t d = a + side;
+					const auto emit = [&](std::size_t local) {
+						corner(positionBase + local, texcoordBase + local, normalBase + local, options);
+					};
+					if (options.quads)
+					{
+						m_text += 'f';
+						emit(a); emit(b); emit(c); emit(d);
+						m_text += '\n';
+					}
+					else
+					{
+						m_text += 'f';
+						emit(a); emit(b); emit(c);
+						m_text += "\nf";
+						emit(a); emit(c); emit(d);
+						m_text += '\n';
+					}
+				}
+				flushIfLarge();
+			}
+		}
+
+		void Flush()
+		{
+			m_stream.write(m_text.data(), static_cast<std::streamsize>(m_text.size()));
+			m_text.clear();
+		}
+	};
+
+	[[nodiscard]] std::size_t scaled_resolution(std::size_t baseResolution, double scale)
+	{
+		// 정점 수가 scale에 비례하도록 한 변은 제곱근으로 늘린다.
+		const double resolution = static_cast<double>(baseResolution) * std::sqrt(std::max(scale, 0.0));
+		return std::max<std::size_t>(2, static_cast<std::size_t>(resolution));
+	}
+
+	constexpr std::size_t material_count = 16;
+	constexpr int texture_size = 256;
+	constexpr std::string_view texture_name = "bench.tga";
+
+	// 비압축 32비트 TGA. stb_image가 읽을 수 있는 가장 단순한 형식이라 인코더가 필요 없다.
+	// 그라데이션 위에 체커를 얹어 BC1 블록마다 끝점과 인덱스가 달라지게 한다.
+	void write_texture(const std::filesystem::path& path)
+	{
+		std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+		if (!stream)
+			throw std::runtime_error("Unable to create corpus file: " + path.string());
+
+		const unsigned char header[18] = {
+			0, 0, 2,					// ID 없음, 팔레트 없음, 비압축 true-color
+			0, 0, 0, 0, 0,
+			0, 0, 0, 0,					// 원점
+			texture_size & 0xFF, texture_size >> 8,
+			texture_size & 0xFF, texture_size >> 8,
+			32, 0x28					// BGRA, 위쪽 행부터, alpha 8비트
+		};
+		std::string texels(reinterpret_cast<const char*>(header), sizeof(header));
+		texels.reserve(sizeof(header) + std::size_t{ texture_size } * texture_size * 4);
+		for (int y = 0; y < texture_size; ++y)
+		{
+			for (int x = 0; x < texture_size; ++x)
+			{
+				const bool dark = (((x >> 5) ^ (y >> 5)) & 1) != 0;
+				const int shade = dark ? 2 : 1;
+				texels += static_cast<char>(128 / shade);
+				texels += static_cast<char>(y / shade);
+				texels += static_cast<char>(x / shade);
+				texels += static_cast<char>(255);
+			}
+		}
+		stream.write(texels.data(), static_cast<std::streamsize>(texels.size()));
+	}
+
+	void write_material_library(const std::filesystem::path& path, ETextureFormat textureFormat)
+	{
+		std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+		if (!stream)
+			throw std::runtime_error("Unable to create corpus file: " + path.string());
+		for (std::size_t i = 0; i < material_count; ++i)
+		{
+			const float tint = static_cast<float>(i) / static_cast<float>(material_count);
+			stream << "newmtl bench_" << i << '\n'
+				<< "Ka 0.1 0.1 0.1\n"
+				<< "Kd " << tint << ' ' << 1.0f - tint << " 0.5\n"
+				<< "Ks 0.2 0.2 0.2\n"
+				<< "Ns 32\n"
+				<< "sr_texture_format " << TextureFormatName(textureFormat) << '\n'
+				<< "map_Kd " << texture_name << "\n\n";
+		}
+	}
+}
+
+std::vector<CorpusFile> GenerateObjCorpus(const std::filesystem::path& directory, double scale, ETextureFormat textureFormat)
+{
+	std::filesystem::create_directories(directory);
+	write_texture(directory / texture_name);
+	write_material_library(directory / "bench.mtl", textureFormat);
+
+	std::vector<CorpusFile> files;
+
+	// 1) 작은 그룹이 많은 파일: 메시 전환, 재질 조회, 작은 메시 후처리의 고정 비용.
+	{
+		CorpusFile file{ "many_groups", "16x16 quads per group, usemtl every group", directory / "many_groups.obj" };
+		const std::size_t groupsPerSide = scaled_resolution(40, scale);
+		ObjWriter writer(file.path);
+		writer.Line("mtllib bench.mtl");
+		for (std::size_t group = 0; group < groupsPerSide * groupsPerSide; ++group)
+		{
+			writer.Line("g part_" + std::to_string(group));
+			writer.Line("usemtl bench_" + std::to_string(group % material_count));
+			GridOptions options;
+			options.resolution = 16;
+			options.originX = static_cast<float>(group % groupsPerSide);
+			options.originY = static_cast<float>(group / groupsPerSide);
+			writer.Grid(options);
+		}
+		files.push_back(std::move(file));
+	}
+
+	// 2) 거대 단일 메시: 정점 중복 제거 표와 옥트리 빌드가 지배한다.
+	{
+		CorpusFile file{ "huge_mesh", "one triangulated v/vt/vn grid", directory / "huge_mesh.obj" };
+		ObjWriter writer(file.path);
+		writer.Line("mtllib bench.mtl");
+		writer.Line("usemtl bench_0");
+		GridOptions options;
+		options.resolution = scaled_resolution(700, scale);
+		options.size = 64.0f;
+		writer.Grid(options);
+		files.push_back(std::move(file));
+	}
+
+	// 3) 사각형 면: 면 분할 경로.
+	{
+		CorpusFile file{ "quads", "one v/vt/vn grid of quad faces", directory / "quads.obj" };
+		ObjWriter writer(file.path);
+		writer.Line("mtllib bench.mtl");
+		writer.Line("usemtl bench_1");
+		GridOptions options;
+		options.resolution = scaled_resolution(700, scale);
+		options.size = 64.0f;
+		options.quads = true;
+		writer.Grid(options);
+		files.push_back(std::move(file));
+	}
+
+	// 4) 법선 없음: 매끄러운 법선 생성 경로.
+	{
+		CorpusFile file{ "no_normals", "v/vt grid without vn, normals generated", directory / "no_normals.obj" };
+		ObjWriter writer(file.path);
+		writer.Line("mtllib bench.mtl");
+		writer.Line("usemtl bench_2");
+		GridOptions options;
+		options.resolution = scaled_resolution(700, scale);
+		options.size = 64.0f;
+		options.normals = false;
+		writer.Grid(options);
+		files.push_back(std::move(file));
+	}
+
+	return files;
+}
@@ -0,0 +1,20 @@
+﻿#pragma once
+#include <filesystem>
+#include <string>
+#include <vector>
+#include "Graphics/TextureTypes.h"
+
+// 로더 벤치마크용 합성 OBJ/MTL 한 벌. 각 파일은 로더의 서로 다른 경로
+// (그룹/재질 전환, 단일 거대 메시의 중복 제거, 사각형 분할, 법선 생성)를 겨냥한다.
+struct CorpusFile
+{
+	std::string name;
+	std::string description;
+	std::filesystem::path path;
+};
+
+// directory에 코퍼스를 만들고 파일 목록을 돌려준다. scale은 각 파일의
+// 정점 수에 곱해진다(1.0 = 파일당 약 50~100MB). 이미 있는 파일은 덮어쓴다.
+// 모든 재질은 같은 diffuse 텍스처를 참조하며 textureFormat으로 내부 포맷을 고른다.
+[[nodiscard]] std::vector<CorpusFile> GenerateObjCorpus(const std::filesystem::path& directory, double scale,
+	ETextureFormat textureFormat = ETextureFormat::RGBA8);